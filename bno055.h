@@ -0,0 +1,346 @@
+/* ------------------------------------------------------------ *
+ * file:        bno055.h                                        *
+ * purpose:     Public header of libbno055, the sensor access   *
+ *              functions of i2c_bno055.c with the bus backends *
+ *              as static and shared library. The functions do  *
+ *              not print and do not exit: they return 0 or the *
+ *              value, or -1 with the reason in bno_strerror(). *
+ *              Link with -lbno055 -lm.                         *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#ifndef BNO055_H
+#define BNO055_H
+
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BNO055_API_VERSION   2        // changes with incompatible API
+
+/* ------------------------------------------------------------ *
+ * The library is built with -fvisibility=hidden, so that only  *
+ * the declarations in this header are exported from the .so,   *
+ * between the visibility push and pop below. All public names  *
+ * carry the bno_ or BNO_ prefix, the internals in getbno055.h  *
+ * as well, so they do not clash with names in the program.     *
+ * ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ *
+ * BNO055 versions, status data and other infos struct          *
+ * ------------------------------------------------------------ */
+struct bnoinf{
+   char chip_id;  // reg 0x00 default 0xA0
+   char acc_id;   // reg 0x01 default 0xFB
+   char mag_id;   // reg 0x02 default 0x32
+   char gyr_id;   // reg 0x03 default 0x0F
+   char sw_lsb;   // reg 0x04 default 0x08
+   char sw_msb;   // reg 0x05 default 0x03
+   char bl_rev;   // reg 0x06 no default
+   char opr_mode; // reg 0x3D default 0x1C
+   char pwr_mode; // reg 0x3E default 0x00
+   char axr_conf; // reg 0x41 default 0x24
+   char axr_sign; // reg 0x42 default 0x00
+   char sys_stat; // reg 0x39 system error status, range 0-6
+   char selftest; // reg 0x36 self test result
+   char sys_err;  // reg 0x3a system error code, 0=OK
+   char unitsel;  // reg 0x3b SI units definition
+   char temp_val; // reg 0x34 sensor temperature value
+};
+
+/* ------------------------------------------------------------ *
+ * BNO055 calibration data struct. The offset ranges depend on  *
+ * the component operation range. For example, the accelerometer*
+ * range can be set as 2G, 4G, 8G, and 16G. I.e. the offset for *
+ * the accelerometer at 16G has a range of +/- 16000mG. Offset  *
+ * is stored on the sensor in two bytes with max value of 32768.*
+ * ------------------------------------------------------------ */
+struct bnocal{
+   char scal_st;  // reg 0x35 system calibration state, range 0-3
+   char gcal_st;  // gyroscope calibration state, range 0-3
+   char acal_st;  // accelerometer calibration state, range 0-3
+   char mcal_st;  // magnetometer calibration state, range 0-3
+   int  aoff_x;   // accelerometer offset, X-axis
+   int  aoff_y;   // accelerometer offset, Y-axis
+   int  aoff_z;   // accelerometer offset, Z-axis
+   int  moff_x;   // magnetometer offset, X-axis
+   int  moff_y;   // magnetometer offset, Y-axis
+   int  moff_z;   // magnetometer offset, Z-axis
+   int  goff_x;   // gyroscope offset, X-axis
+   int  goff_y;   // gyroscope offset, Y-axis
+   int  goff_z;   // gyroscope offset, Z-axis
+   int acc_rad;   // accelerometer radius
+   int mag_rad;   // magnetometer radius
+};
+
+/* ------------------------------------------------------------ *
+ * BNO055 measurement data structs. Data gets filled in based   *
+ * on the sensor component type that was requested for reading. *
+ * ------------------------------------------------------------ */
+struct bnoacc{
+   double adata_x;   // accelerometer data, X-axis
+   double adata_y;   // accelerometer data, Y-axis
+   double adata_z;   // accelerometer data, Z-axis
+};
+struct bnomag{
+   double mdata_x;   // magnetometer data, X-axis
+   double mdata_y;   // magnetometer data, Y-axis
+   double mdata_z;   // magnetometer data, Z-axis
+};
+struct bnogyr{
+   double gdata_x;   // gyroscope data, X-axis
+   double gdata_y;   // gyroscope data, Y-axis
+   double gdata_z;   // gyroscope data, Z-axis
+};
+struct bnoeul{
+   double eul_head;  // Euler heading data
+   double eul_roll;  // Euler roll data
+   double eul_pitc;  // Euler picth data
+};
+struct bnoqua{
+   double quater_w;  // Quaternation data W
+   double quater_x;  // Quaternation data X
+   double quater_y;  // Quaternation data Y
+   double quater_z;  // Quaternation data Z
+};
+struct bnogra{
+   double gravityx;  // Gravity Vector X
+   double gravityy;  // Gravity Vector Y
+   double gravityz;  // Gravity Vector Z
+};
+struct bnolin{
+   double linacc_x;  // Linear Acceleration X
+   double linacc_y;  // Linear Acceleration Y
+   double linacc_z;  // Linear Acceleration Z
+};
+
+/* ------------------------------------------------------------ *
+ * Channel mask bits, one per data type, in register map order. *
+ * A sample carries the mask of the channels that were read.    *
+ * ------------------------------------------------------------ */
+#define BNO_CH_ACC           0x0001  // reg 0x08 accelerometer
+#define BNO_CH_MAG           0x0002  // reg 0x0E magnetometer
+#define BNO_CH_GYR           0x0004  // reg 0x14 gyroscope
+#define BNO_CH_EUL           0x0008  // reg 0x1A euler orientation
+#define BNO_CH_QUA           0x0010  // reg 0x20 quaternation
+#define BNO_CH_LIN           0x0020  // reg 0x28 linear acceleration
+#define BNO_CH_GRA           0x0040  // reg 0x2E gravity vector
+#define BNO_CH_COUNT         7
+#define BNO_CH_ALL           0x007F
+#define BNO_CH_TMP           0x0080  // reg 0x34 temperature, one byte
+
+struct bnosample{
+   struct timespec ts; // host time (CLOCK_REALTIME) of the reading
+   int mask;           // channels present, BNO_CH_* bits
+   struct bnoacc acc;
+   struct bnomag mag;
+   struct bnogyr gyr;
+   struct bnoeul eul;
+   struct bnoqua qua;
+   struct bnolin lin;
+   struct bnogra gra;
+   double temp;        // temperature in Celsius or Fahrenheit
+};
+
+/* ------------------------------------------------------------ *
+ * Raw data channel values as int16 register content. All data  *
+ * registers 0x08-0x33 are 22 LSB/MSB pairs, value i is located *
+ * at register 0x08 + 2*i, independent of the channels in mask. *
+ * ------------------------------------------------------------ */
+#define BNO_RAW_COUNT        22
+#define BNO_RAW_STATUS       0x0100  // bno_get_raw() mask bit, status 0x39-0x3D
+#define BNO_RAW_CALIB        0x0200  // bno_get_raw() mask bit, CALIB_STAT 0x35
+
+struct bnoraw{
+   struct timespec ts; // host time (CLOCK_REALTIME) of the reading
+   int mask;           // channels present, BNO_CH_* bits
+   int16_t val[BNO_RAW_COUNT]; // raw values in register order
+   int64_t t0;         // CLOCK_MONOTONIC nsec before the I2C transaction
+   int64_t t1;         // CLOCK_MONOTONIC nsec after the I2C transaction
+   uint8_t calstat;    // 0x35 CALIB_STAT, with BNO_RAW_CALIB only
+   uint8_t sysstat;    // status registers, with BNO_RAW_STATUS only:
+   uint8_t syserr;     // 0x39 SYS_STATUS, 0x3A SYS_ERR,
+   uint8_t oprmode;    // 0x3D OPR_MODE
+   int8_t temp;        // 0x34 TEMP, with BNO_CH_TMP from bno_get_plan()
+};
+
+/* ------------------------------------------------------------ *
+ * Read plan: the bursts that read a channel set with the least *
+ * bus time. A burst costs two transfers with host overhead and *
+ * address bytes, each data byte 9 bus clocks.                  *
+ * ------------------------------------------------------------ */
+#define BNO_PLAN_MAX         8        // bursts in a plan
+#define BNO_PLAN_KHZ         100      // bus clock if not configured
+#define BNO_PLAN_XFER_US     60       // host time per transfer, usec
+
+struct bnoplan{
+   int mask;           // BNO_CH_*, BNO_RAW_STATUS and BNO_RAW_CALIB bits
+   int khz;            // bus clock of the cost estimate
+   int count;          // number of bursts
+   uint8_t reg[BNO_PLAN_MAX]; // first register of each burst
+   uint8_t len[BNO_PLAN_MAX]; // bytes of each burst
+   int bytes;          // bytes read in all bursts
+   int used;           // bytes of the requested data
+   double cost;        // estimated bus time in usec
+   double single;      // estimate for one burst over all data
+};
+
+/* ------------------------------------------------------------ *
+ * Register map dump, both pages read with one burst per page   *
+ * ------------------------------------------------------------ */
+#define BNO_PAGE_SIZE        128
+
+struct bnoregs{
+   struct timespec ts; // host time (CLOCK_REALTIME) of the dump
+   unsigned char page[2][BNO_PAGE_SIZE]; // page 0 and page 1 registers
+};
+
+/* ------------------------------------------------------------ *
+ * BNO055 accelerometer gyroscope magnetometer config structs   *
+ * ------------------------------------------------------------ */
+struct bnoaconf{
+   int pwrmode;      // p-1 reg 0x08 accelerometer power mode
+   int bandwth;      // p-1 reg 0x08 accelerometer bandwidth
+   int range;        // p-1 reg 0x08 accelerometer rate
+   int slpmode;      // p-1 reg 0x0C accelerometer sleep mode
+   int slpdur;       // p-1 reg 0x0C accelerometer sleep duration
+};
+struct bnoint{
+   int enable;       // p-1 reg 0x10 enabled interrupt sources
+   int mask;         // p-1 reg 0x0F sources that drive the INT pin
+   int am_thres;     // p-1 reg 0x11 acc any-motion threshold
+   int am_dur;       // p-1 reg 0x12 acc any-motion samples - 1
+   int hg_dur;       // p-1 reg 0x13 acc high-g duration (n+1)*2ms
+   int hg_thres;     // p-1 reg 0x14 acc high-g threshold
+   int nm_thres;     // p-1 reg 0x15 acc no-motion threshold
+   int nm_dur;       // p-1 reg 0x16 acc no-motion duration code
+   int hr_thres;     // p-1 reg 0x18 gyr high-rate threshold, xyz
+   int hr_dur;       // p-1 reg 0x19 gyr high-rate duration, xyz
+   int gam_thres;    // p-1 reg 0x1E gyr any-motion threshold
+};
+struct bnomconf{
+   int pwrmode;      // p-1 reg 0x09 magnetometer power mode
+   int oprmode;      // p-1 reg 0x09 magnetometer operation
+   int outrate;      // p-1 reg 0x09 magnetometer output rate
+};
+struct bnogconf{
+   int pwrmode;      // p-1 reg 0x0B gyroscope power mode
+   int bandwth;      // p-1 reg 0x0A gyroscope bandwidth
+   int range;        // p-1 reg 0x0A gyroscope range
+   int slpdur;       // p-1 reg 0x0D gyroscope sleep duration
+   int aslpdur;      // p-1 reg 0x0D gyroscope auto sleep dur
+};
+
+/* ------------------------------------------------------------ *
+ * Operations and power mode, name to value translation         *
+ * ------------------------------------------------------------ */
+typedef enum {
+   BNO_MODE_CONFIG   = 0x00,
+   BNO_MODE_ACCONLY  = 0x01,
+   BNO_MODE_MAGONLY  = 0x02,
+   BNO_MODE_GYRONLY  = 0x03,
+   BNO_MODE_ACCMAG   = 0x04,
+   BNO_MODE_ACCGYRO  = 0x05,
+   BNO_MODE_MAGGYRO  = 0x06,
+   BNO_MODE_AMG      = 0x07,
+   BNO_MODE_IMU      = 0x08,
+   BNO_MODE_COMPASS  = 0x09,
+   BNO_MODE_M4G      = 0x0A,
+   BNO_MODE_NDOF     = 0x0B,
+   BNO_MODE_NDOF_FMC = 0x0C
+} bno_opmode_t;
+
+typedef enum {
+   BNO_PWR_NORMAL  = 0x00,
+   BNO_PWR_LOW     = 0x01,
+   BNO_PWR_SUSPEND = 0x02
+} bno_power_t;
+
+/* ------------------------------------------------------------ *
+ * Interrupt sources, same bits in INT_EN, INT_MSK and INT_STA  *
+ * ------------------------------------------------------------ */
+#define BNO_INT_GYR_AM       0x04     // gyroscope any-motion
+#define BNO_INT_GYR_HR       0x08     // gyroscope high-rate
+#define BNO_INT_ACC_HG       0x20     // accelerometer high-g
+#define BNO_INT_ACC_AM       0x40     // accelerometer any-motion
+#define BNO_INT_ACC_NM       0x80     // accelerometer no-motion
+#define BNO_SYS_RST_INT      0x40     // SYS_TRIGGER: reset INT pin
+
+/* ------------------------------------------------------------ *
+ * Transport counters, kept for every transfer and sensor wait  *
+ * ------------------------------------------------------------ */
+struct bnostats{
+   uint64_t xfers;     // read and write transactions
+   uint64_t rdbytes;   // bytes read
+   uint64_t wrbytes;   // bytes written, incl. register address
+   uint64_t pages;     // writes to PAGE_ID
+   uint64_t modes;     // writes to OPR_MODE
+   uint64_t rderr;     // failed or short reads
+   uint64_t wrerr;     // failed or short writes
+   uint64_t retries;   // transfers repeated after an error
+   uint64_t busyns;    // nsec spent in transfers
+   uint64_t sleepns;   // nsec spent waiting for the sensor
+};
+
+#pragma GCC visibility push(default)
+
+/* ------------------------------------------------------------ *
+ * Library functions, the device is "sim" or e.g. "/dev/i2c-1"  *
+ * ------------------------------------------------------------ */
+extern int bno_open(const char*, int);        // open bus, probe sensor addr
+extern void bno_close(void);                  // release the bus device
+extern void bno_set_debug(int);               // 1 = print "Debug:" lines
+extern const char *bno_strerror(void);        // message of the last error
+extern int bno_get_stats(struct bnostats*);   // counters of the open device
+extern int bno_read(int, void*, int);         // burst read from register
+extern int bno_get_calstatus(struct bnocal*); // read calibration status
+extern int bno_get_caloffset(struct bnocal*); // read calibration values
+extern int bno_get_inf(struct bnoinf*);       // read sensor information
+extern int bno_get_acc(struct bnoacc*);       // read accelerometer data
+extern int bno_get_mag(struct bnomag*);       // read magnetometer data
+extern int bno_get_gyr(struct bnogyr*);       // read gyroscope data
+extern int bno_get_eul(struct bnoeul*);       // read euler orientation
+extern int bno_get_qua(struct bnoqua*);       // read quaternation data
+extern int bno_get_gra(struct bnogra*);       // read gravity data
+extern int bno_get_lin(struct bnolin*);       // read linar acceleration data
+extern int bno_get_raw(struct bnoraw*, int);  // burst read raw channel data
+extern int bno_raw_chan(int, int*);           // raw index and count of chan
+extern int bno_plan_mask(const char*);        // "acc,gyr,temp" to BNO_CH_*
+extern int bno_plan_khz(const char*);         // bus clock of the i2c device
+extern int bno_plan(struct bnoplan*, int, int); // bursts for mask, kHz
+extern int bno_get_plan(struct bnoplan*, struct bnoraw*); // run the bursts
+extern void bno_raw_to_sample(struct bnoraw*, struct bnosample*, int);
+extern int bno_get_unit(void);                // get the SI unit selection
+extern int bno_get_clksrc(void);              // get the clock source setting
+extern int bno_get_clkstat(void);             // clock source config status
+extern int bno_set_clksrc(int);               // 1 = external, 0 = internal
+extern int bno_set_mode(bno_opmode_t);        // set the sensor ops mode
+extern int bno_get_mode(void);                // get the sensor ops mode
+extern int bno_get_modecode(const char*);     // ops mode name to bno_opmode_t
+extern int bno_set_power(bno_power_t);        // set the sensor power mode
+extern int bno_get_power(void);               // get the sensor power mode
+extern int bno_get_pwrcode(const char*);      // power mode name to bno_power_t
+extern int bno_get_sstat(void);               // get system status code
+extern int bno_get_remap(char);               // get the axis remap values
+extern int bno_get_acc_conf(struct bnoaconf*); // get accelerometer config
+extern int bno_get_int_conf(struct bnoint*);  // get interrupt config
+extern int bno_set_int_conf(struct bnoint*);  // set interrupt config
+extern int bno_get_intstat(void);             // read and clear INT_STA
+extern int bno_int_reset(void);               // reset the INT pin
+extern int bno_dump(struct bnoregs*);         // read both register pages
+extern int bno_snapshot(struct bnoregs*);     // register pages in CONFIG mode
+extern int bno_restore(struct bnoregs*);      // write back differing setup
+extern int bno_reset(void);                   // reset the sensor
+extern int bno_save_cal(const char*);         // write calibration to file
+extern int bno_load_cal(const char*);         // load calibration from file
+
+#pragma GCC visibility pop
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,177 @@
+/* ------------------------------------------------------------ *
+ * file:        bno055.hpp                                      *
+ * purpose:     Header-only C++17 layer over libbno055. The     *
+ *              data registers are constexpr channel types with *
+ *              address, value count, width and scale factor,   *
+ *              and read<Acc, Eul>() computes the single burst  *
+ *              that covers the channels at compile time. The   *
+ *              result is a typed struct, decoded with offsets  *
+ *              that are all constants:                         *
+ *                                                              *
+ *              bno055::bus dev("/dev/i2c-1", 0x28);            *
+ *              auto r = bno055::read<bno055::Eul>();           *
+ *              if(r) printf("%f\n", r->get<bno055::Eul>()[0]); *
+ *                                                              *
+ *              The scale factors are for the default units,    *
+ *              UNIT_SEL 0x00: m/s^2, uT, dps, degrees, Celsius.*
+ *              Link with -lbno055 -lm.                         *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#ifndef BNO055_HPP
+#define BNO055_HPP
+
+#if __cplusplus < 201703L
+#error "bno055.hpp needs C++17"
+#endif
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <array>
+#include <algorithm>
+#include <optional>
+#include <type_traits>
+#include "bno055.h"
+
+namespace bno055 {
+
+/* ------------------------------------------------------------ *
+ * Page-0 registers that the channels below do not cover        *
+ * ------------------------------------------------------------ */
+namespace reg {
+   constexpr uint8_t chip_id   = 0x00;
+   constexpr uint8_t page_id   = 0x07;
+   constexpr uint8_t data_lo   = 0x08;   // first data register
+   constexpr uint8_t int_sta   = 0x37;   // cleared by any read
+   constexpr uint8_t unit_sel  = 0x3B;
+   constexpr uint8_t opr_mode  = 0x3D;
+}
+
+/* ------------------------------------------------------------ *
+ * Channel descriptor: register, number of values, bytes per    *
+ * value (2 = int16 LSB/MSB, 1 = one byte), value type, scale   *
+ * to the unit, and the BNO_CH_* bit for the fusion channels.   *
+ * ------------------------------------------------------------ */
+template <uint8_t Reg, int Count, int Width, class T, class Scale, int Mask>
+struct channel {
+   static constexpr uint8_t reg   = Reg;
+   static constexpr int     count = Count;
+   static constexpr int     width = Width;
+   static constexpr int     bytes = Count * Width;
+   static constexpr int     mask  = Mask;
+   static constexpr double  scale = double(Scale::num) / double(Scale::den);
+   using type = T;
+   static_assert(Width == 1 || Width == 2, "channel width is 1 or 2 bytes");
+   static_assert(Width == int(sizeof(T)), "channel type does not match its width");
+};
+
+template <long Num, long Den> struct ratio { static constexpr long num = Num, den = Den; };
+
+struct Acc  : channel<0x08, 3, 2, int16_t, ratio<1, 100>,   BNO_CH_ACC> {}; // m/s^2
+struct Mag  : channel<0x0E, 3, 2, int16_t, ratio<1, 16>,    BNO_CH_MAG> {}; // uT
+struct Gyr  : channel<0x14, 3, 2, int16_t, ratio<1, 16>,    BNO_CH_GYR> {}; // dps
+struct Eul  : channel<0x1A, 3, 2, int16_t, ratio<1, 16>,    BNO_CH_EUL> {}; // H R P degrees
+struct Qua  : channel<0x20, 4, 2, int16_t, ratio<1, 16384>, BNO_CH_QUA> {}; // W X Y Z
+struct Lin  : channel<0x28, 3, 2, int16_t, ratio<1, 100>,   BNO_CH_LIN> {}; // m/s^2
+struct Gra  : channel<0x2E, 3, 2, int16_t, ratio<1, 100>,   BNO_CH_GRA> {}; // m/s^2
+struct Temp : channel<0x34, 1, 1, int8_t,  ratio<1, 1>,     0> {};          // Celsius
+struct Cal  : channel<0x35, 1, 1, uint8_t, ratio<1, 1>,     0> {};          // 2 bits S G A M
+struct Stat : channel<0x39, 1, 1, uint8_t, ratio<1, 1>,     0> {};          // SYS_STATUS
+struct Err  : channel<0x3A, 1, 1, uint8_t, ratio<1, 1>,     0> {};          // SYS_ERR
+
+/* ------------------------------------------------------------ *
+ * value<Ch> holds the register values of one channel, and []   *
+ * returns value i in the unit                                  *
+ * ------------------------------------------------------------ */
+template <class Ch>
+struct value {
+   std::array<typename Ch::type, Ch::count> raw;
+   constexpr double operator[](int i) const { return raw[i] * Ch::scale; }
+};
+
+template <class Ch, class... Chs>
+constexpr bool contains = (std::is_same_v<Ch, Chs> || ...);
+
+template <class... Chs> struct distinct : std::true_type {};
+template <class Ch, class... Chs>
+struct distinct<Ch, Chs...> : std::bool_constant<! contains<Ch, Chs...> && distinct<Chs...>::value> {};
+
+/* ------------------------------------------------------------ *
+ * burst<Ch...> is the register range of the read: from the     *
+ * lowest channel register to the end of the highest channel.   *
+ * ------------------------------------------------------------ */
+template <class... Chs>
+struct burst {
+   static_assert(sizeof...(Chs) > 0, "read<>() needs at least one channel");
+   static_assert(distinct<Chs...>::value, "a channel is listed twice");
+   static constexpr uint8_t first = std::min({ Chs::reg... });
+   static constexpr uint8_t end   = std::max({ uint8_t(Chs::reg + Chs::bytes)... });
+   static constexpr int     len   = end - first;
+   static constexpr int     mask  = (Chs::mask | ...);
+   static_assert(first >= reg::data_lo && end <= reg::opr_mode, "channel outside the data registers");
+   static_assert(first > reg::int_sta || end <= reg::int_sta,
+                 "burst spans INT_STA 0x37 and would clear pending interrupts, read it in two calls");
+};
+
+/* ------------------------------------------------------------ *
+ * reading<Ch...> has one value<Ch> per requested channel       *
+ * ------------------------------------------------------------ */
+template <class... Chs>
+struct reading : value<Chs>... {
+   static constexpr int mask = burst<Chs...>::mask;
+
+   template <class Ch>
+   const value<Ch> &get() const {
+      static_assert(contains<Ch, Chs...>, "channel was not read");
+      return(*this);
+   }
+};
+
+/* ------------------------------------------------------------ *
+ * decode() assembles the values of one channel from the burst, *
+ * p points to the channel register inside the buffer. On little*
+ * endian hosts the register layout is the memory layout, and a *
+ * fixed size copy compiles to plain loads.                     *
+ * ------------------------------------------------------------ */
+template <class Ch>
+inline void decode(value<Ch> &v, const uint8_t *p) {
+   if constexpr (Ch::width == 1 || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+      std::memcpy(v.raw.data(), p, Ch::bytes);
+   else
+      for(int i = 0; i < Ch::count; i++) v.raw[i] = int16_t(p[2*i] | (p[2*i+1] << 8));
+}
+
+/* ------------------------------------------------------------ *
+ * read<Ch...>() reads all channels with one register burst.    *
+ * Returns the reading, or nullopt with bno_strerror() set.     *
+ * ------------------------------------------------------------ */
+template <class... Chs>
+inline std::optional<reading<Chs...>> read() {
+   using b = burst<Chs...>;
+   uint8_t buf[b::len];
+   if(bno_read(b::first, buf, b::len) != 0) return(std::nullopt);
+   reading<Chs...> r;
+   (decode<Chs>(r, buf + (Chs::reg - b::first)), ...);
+   return(r);
+}
+
+/* ------------------------------------------------------------ *
+ * bus opens the sensor for the lifetime of the object. The     *
+ * library has one device, so only one bus can be open.         *
+ * ------------------------------------------------------------ */
+class bus {
+public:
+   bus(const char *dev, int addr = 0x28) : ok(bno_open(dev, addr) == 0) {}
+   ~bus() { if(ok) bno_close(); }
+   bus(const bus&) = delete;
+   bus &operator=(const bus&) = delete;
+   explicit operator bool() const { return(ok); }
+   const char *error() const { return(bno_strerror()); }
+private:
+   bool ok;
+};
+
+} // namespace bno055
+
+#endif
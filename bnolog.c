@@ -0,0 +1,235 @@
+/* ------------------------------------------------------------ *
+ * file:        bnolog.c                                        *
+ * purpose:     Decoder for the compressed raw data log written *
+ *              by "getbno055 -t con -L logfile". Outputs the   *
+ *              samples in the getbno055 -F formats, or as the  *
+ *              bit-exact raw int16 register values with -r.    *
+ *              A time range (-s/-e) is found through the block *
+ *              index without decoding the data before it.      *
+ *              A flight recorder ring file (getbno055 -f) gets *
+ *              decoded from its oldest to its newest sample.   *
+ *                                                              *
+ * return:      0 on success, and -1 on errors.                 *
+ *                                                              *
+ * example:	./bnolog -F csv bno055.bnl                      *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <string.h>
+#include <getopt.h>
+#include "getbno055.h"
+
+/* ------------------------------------------------------------ *
+ * Global variables and defaults                                *
+ * ------------------------------------------------------------ */
+int verbose = 0;
+int rawflag = 0;
+int outfmt = fmt_txt;
+int step = 1;                     // output every n-th record
+int preview = 0;                  // number of evenly spaced points
+int64_t tstart = -1;              // range start in usec, -1 = file start
+int64_t tend = -1;                // range end in usec, -1 = file end
+char logfile[256];
+
+/* ------------------------------------------------------------ *
+ * print_usage() prints the programs commandline instructions.  *
+ * ------------------------------------------------------------ */
+void usage() {
+   static char const usage[] = "Usage: bnolog [-r] [-F txt|csv|jsonl|bin] [-s start] [-e end] [-n step] [-p points] [-v] logfile\n\
+\n\
+Command line parameters have the following format:\n\
+   -r   output the raw int16 register values instead of converted data\n\
+   -F   output format for converted data, see getbno055 -h (default txt)\n\
+   -s   range start time in epoch seconds, e.g. -s 1541945387.5\n\
+   -e   range end time in epoch seconds, e.g. -e 1541945390\n\
+   -n   output only every n-th record of the range, e.g. -n 100\n\
+   -p   preview: output n records evenly spaced over the range in time\n\
+   -h   display this message\n\
+   -v   enable debug output\n\
+\n\
+Usage examples:\n\
+./bnolog ./bno055.bnl\n\
+./bnolog -F csv ./bno055.bnl > bno055.csv\n\
+./bnolog -s 1541945387 -e 1541945397 ./bno055.bnl\n\
+./bnolog -p 500 -F csv ./bno055.bnl\n\
+./bnolog -F csv ./bno055.ring\n";
+   printf(usage);
+}
+
+/* ------------------------------------------------------------ *
+ * parseargs() checks the commandline arguments with C getopt   *
+ * ------------------------------------------------------------ */
+void parseargs(int argc, char* argv[]) {
+   int arg;
+   opterr = 0;
+
+   if(argc == 1) { usage(); exit(-1); }
+
+   while ((arg = (int) getopt (argc, argv, "rF:s:e:n:p:hv")) != -1) {
+      switch (arg) {
+         // arg -v verbose, type: flag, optional
+         case 'v':
+            verbose = 1; break;
+
+         // arg -r raw output, type: flag, optional
+         case 'r':
+            rawflag = 1; break;
+
+         // arg -s + range start time, type: seconds
+         case 's':
+            tstart = strtod(optarg, NULL) * 1000000;
+            break;
+
+         // arg -e + range end time, type: seconds
+         case 'e':
+            tend = strtod(optarg, NULL) * 1000000;
+            break;
+
+         // arg -n + record step, type: integer
+         case 'n':
+            if((step = atoi(optarg)) < 1) {
+               printf("Error: invalid -n step argument.\n");
+               exit(-1);
+            }
+            break;
+
+         // arg -p + preview points, type: integer
+         case 'p':
+            if((preview = atoi(optarg)) < 1) {
+               printf("Error: invalid -p points argument.\n");
+               exit(-1);
+            }
+            break;
+
+         // arg -F + output format, type: string
+         case 'F':
+            if((outfmt = get_outfmt(optarg)) < 0) {
+               printf("Error: invalid -F output format argument.\n");
+               exit(-1);
+            }
+            break;
+
+         // arg -h usage, type: flag, optional
+         case 'h':
+            usage(); exit(0);
+            break;
+
+         case '?':
+            if(isprint (optopt))
+               printf ("Error: Unknown option `-%c'.\n", optopt);
+            else
+               printf ("Error: Unknown option character `\\x%x'.\n", optopt);
+            usage();
+            exit(-1);
+            break;
+
+         default:
+            usage();
+            break;
+      }
+   }
+   if(optind >= argc || strlen(argv[optind]) >= sizeof(logfile)) {
+      printf("Error: missing or invalid logfile argument.\n");
+      exit(-1);
+   }
+   strncpy(logfile, argv[optind], sizeof(logfile));
+}
+
+/* ------------------------------------------------------------ *
+ * print_raw() outputs one record in the selected output format *
+ * ------------------------------------------------------------ */
+void print_raw(struct bnoraw *raw, int nval, int *idx, int unitsel) {
+   struct bnosample bnos;
+   int i;
+
+   if(rawflag == 1) {
+      /* ----------------------------------------------------- *
+       * RAW 1541945387.204511 -45 264 939 ... (register order)*
+       * ----------------------------------------------------- */
+      printf("RAW %lld.%06ld", (long long) raw->ts.tv_sec, raw->ts.tv_nsec / 1000);
+      for(i = 0; i < nval; i++) printf(" %d", raw->val[idx[i]]);
+      printf("\n");
+   }
+   else {
+      bno_raw_to_sample(raw, &bnos, unitsel);
+      print_sample(&bnos, outfmt, stdout);
+   }
+}
+
+int main(int argc, char *argv[]) {
+   struct bnolog log;
+   struct bnoraw raw;
+   unsigned long count = 0, n = 0;
+   int res = 0, i;
+
+   parseargs(argc, argv);
+   bno_set_debug(verbose);
+
+   /* ---------------------------------------------------------- *
+    * A flight recorder ring holds uncompressed all-channel data *
+    * ---------------------------------------------------------- */
+   FILE *fp = fopen(logfile, "r");
+   char magic[4] = {0};
+   if(fp != NULL && fread(magic, 1, 4, fp) == 4 && memcmp(magic, BNO_REC_MAGIC, 4) == 0) {
+      struct bnoraw *ring;
+      int idx[BNO_RAW_COUNT], unitsel;
+      fclose(fp);
+      if((res = rec_load(logfile, &ring, &unitsel)) < 0) exit(-1);
+      for(i = 0; i < BNO_RAW_COUNT; i++) idx[i] = i;
+      for(i = 0; i < res; i++) {
+         int64_t us = (int64_t) ring[i].ts.tv_sec * 1000000 + ring[i].ts.tv_nsec / 1000;
+         if((tstart >= 0 && us < tstart) || (tend >= 0 && us > tend)) continue;
+         if(n++ % step == 0) print_raw(&ring[i], BNO_RAW_COUNT, idx, unitsel);
+      }
+      free(ring);
+      exit(0);
+   }
+   if(fp != NULL) fclose(fp);
+
+   if(log_ropen(&log, logfile) != 0) exit(-1);
+   if(verbose == 1) printf("Debug: Log mask [0x%02X] unitsel [0x%02X] values [%d]\n",
+                           log.mask, log.unitsel, log.nval);
+
+   if((tstart >= 0 || preview > 0) && log.nblk == 0) {
+      printf("Error: %s has no time index, only full decoding is possible.\n", logfile);
+      log_rclose(&log);
+      exit(-1);
+   }
+   if(tstart < 0) tstart = log.first;
+   if(tend < 0 || (log.nblk > 0 && tend > log.last)) tend = log.last;
+
+   if(preview > 0) {
+      /* ------------------------------------------------------- *
+       * One seek per point, only the needed blocks get decoded  *
+       * ------------------------------------------------------- */
+      for(i = 0; i < preview; i++) {
+         int64_t t = tstart;
+         if(preview > 1) t += (tend - tstart) * i / (preview - 1);
+         if(log_seek(&log, t) != 0 || (res = log_read(&log, &raw)) != 0) break;
+         print_raw(&raw, log.nval, log.idx, log.unitsel);
+         count++;
+      }
+   }
+   else {
+      if(log.nblk > 0) log_seek(&log, tstart);
+      while((res = log_read(&log, &raw)) == 0) {
+         if(log.nblk > 0 && (int64_t) raw.ts.tv_sec * 1000000 + raw.ts.tv_nsec / 1000 > tend) break;
+         if(n++ % step == 0) {
+            print_raw(&raw, log.nval, log.idx, log.unitsel);
+            count++;
+         }
+      }
+   }
+   log_rclose(&log);
+
+   if(verbose == 1) printf("Debug: Output records: [%lu]\n", count);
+   if(res < 0) {
+      printf("Error: corrupt log data after record %lu.\n", count);
+      exit(-1);
+   }
+   exit(0);
+}
@@ -0,0 +1,327 @@
+/* ------------------------------------------------------------ *
+ * file:        bus_bno055.c                                    *
+ * purpose:     Bus transport for the sensor register access.   *
+ *              All register reads and writes of i2c_bno055.c   *
+ *              go through bno_bus_write() and bno_bus_read(),  *
+ *              which pass them to a backend: the Linux i2c-dev *
+ *              driver, or the simulated sensor with "-b sim".  *
+ *              The transport is the single place to count and  *
+ *              trace the bus operations and the sleeps between *
+ *              them, the counters are exported as Prometheus   *
+ *              metrics for capacity planning of the bus.       *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "getbno055.h"
+
+int bno_debug = 0;       // debug output, set with bno_set_debug()
+int bno_errprint = 0;    // 1 = print the errors, set by the tools
+static char errmsg[256]; // last error message of the library
+
+/* ------------------------------------------------------------ *
+ * bno_set_debug() turns the "Debug:" output of the library on  *
+ * (1) or off (0). The tools pass their -v flag.                *
+ * ------------------------------------------------------------ */
+void bno_set_debug(int on) {
+   bno_debug = on;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_error() records an error of the library functions. Only  *
+ * the command line tools print it, programs linked against the *
+ * library get the message from bno_strerror() after a -1.      *
+ * ------------------------------------------------------------ */
+void bno_error(const char *fmt, ...) {
+   va_list ap;
+   va_start(ap, fmt);
+   vsnprintf(errmsg, sizeof(errmsg), fmt, ap);
+   va_end(ap);
+   errmsg[strcspn(errmsg, "\n")] = '\0';
+   if(bno_errprint == 1) printf("Error: %s\n", errmsg);
+}
+
+const char *bno_strerror(void) {
+   return(errmsg);
+}
+
+/* ------------------------------------------------------------ *
+ * i2c-dev backend: plain read() and write() on the bus device  *
+ * ------------------------------------------------------------ */
+static int i2cfd = -1;   // I2C file descriptor
+
+static int i2c_open(const char *dev, int addr) {
+   if((i2cfd = open(dev, O_RDWR)) < 0) {
+      bno_error("failed to open I2C bus [%s].\n", dev);
+      return(-1);
+   }
+   if(ioctl(i2cfd, I2C_SLAVE, addr) != 0) {
+      bno_error("can't find sensor at address [0x%02X].\n", addr);
+      close(i2cfd);
+      i2cfd = -1;
+      return(-1);
+   }
+   return(0);
+}
+
+static int i2c_write(const void *buf, int len) {
+   return(write(i2cfd, buf, len));
+}
+
+static int i2c_read(void *buf, int len) {
+   return(read(i2cfd, buf, len));
+}
+
+static void i2c_close() {
+   if(i2cfd >= 0) close(i2cfd);
+   i2cfd = -1;
+}
+
+static const struct bnobus i2cbus = {
+   "i2c", i2c_open, i2c_write, i2c_read, i2c_close
+};
+
+/* ------------------------------------------------------------ *
+ * Active backend, the register pointer and page as seen on the *
+ * bus, to label the trace events of the reads, and the device  *
+ * names for the metrics labels.                                *
+ * ------------------------------------------------------------ */
+static const struct bnobus *bus = &i2cbus;
+static int busreg = 0;
+static int buspage = 0;
+static char busdev[256];
+static int busaddr;
+
+struct bnostats bno_busstat;  // transport counters of this device
+
+/* ------------------------------------------------------------ *
+ * bno_get_stats() copies the transport counters of the device. *
+ * ------------------------------------------------------------ */
+int bno_get_stats(struct bnostats *st) {
+   *st = bno_busstat;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_bus_open() selects the backend by the -b argument, "sim" *
+ * for the simulated sensor, anything else is an i2c-dev        *
+ * device. With -j, the fault injection wraps the backend.      *
+ * ------------------------------------------------------------ */
+int bno_bus_open(const char *dev, int addr) {
+   if(strcmp(dev, "sim") == 0) bus = &bno_simbus;
+   else bus = &i2cbus;
+   if(bno_fault_on == 1) bus = bno_fault_wrap(bus);
+   if(bno_debug == 1) printf("Debug: Bus transport: [%s]\n", bus->name);
+   busreg = 0;
+   buspage = 0;
+   snprintf(busdev, sizeof(busdev), "%s", dev);
+   busaddr = addr;
+   return(bus->open(dev, addr));
+}
+
+/* ------------------------------------------------------------ *
+ * bus_wr1() and bus_rd1() are one transfer attempt, counted    *
+ * and traced. Failed or short transfers are counted as errors. *
+ * ------------------------------------------------------------ */
+static int bus_wr1(const unsigned char *p, int len) {
+   int64_t t0 = bno_trace_now();
+   int res = bus->write(p, len);
+   int64_t t1 = bno_trace_now();
+
+   bno_busstat.xfers++;
+   bno_busstat.busyns += t1 - t0;
+   if(res != len) bno_busstat.wrerr++;
+   if(res > 0) {
+      bno_busstat.wrbytes += res;
+      busreg = p[0];
+   }
+   if(res > 1 && p[0] == BNO055_PAGE_ID_ADDR) {
+      bno_busstat.pages++;
+      buspage = p[1];
+   }
+   if(res > 1 && p[0] == BNO055_OPR_MODE_ADDR && buspage == 0) bno_busstat.modes++;
+   if(bno_trace_on == 1)
+      bno_trace_add(len == 1 ? BNO_TR_ADDR : BNO_TR_WRITE, p[0], buspage, len, res, t0, t1, NULL);
+   return(res);
+}
+
+static int bus_rd1(void *buf, int len) {
+   int64_t t0 = bno_trace_now();
+   int res = bus->read(buf, len);
+   int64_t t1 = bno_trace_now();
+
+   bno_busstat.xfers++;
+   bno_busstat.busyns += t1 - t0;
+   if(res != len) bno_busstat.rderr++;
+   if(res > 0) bno_busstat.rdbytes += res;
+   if(bno_trace_on == 1) bno_trace_add(BNO_TR_READ, busreg, buspage, len, res, t0, t1, NULL);
+   return(res);
+}
+
+/* ------------------------------------------------------------ *
+ * bus_backoff() waits before retry n (0..), doubling each time *
+ * ------------------------------------------------------------ */
+static void bus_backoff(int n) {
+   bno_busstat.retries++;
+   if(bno_debug == 1) printf("Debug: Bus transfer failed, retry %d\n", n + 1);
+   bno_bus_sleep(BNO_BUS_BACKOFF_US << n, "retry");
+}
+
+/* ------------------------------------------------------------ *
+ * bno_bus_write() sends len bytes, the first byte is the       *
+ * register address. A failed transfer is repeated up to        *
+ * BNO_BUS_RETRIES times with exponential backoff, register     *
+ * writes can safely be repeated. Returns the bytes written     *
+ * like write() does.                                           *
+ * ------------------------------------------------------------ */
+int bno_bus_write(const void *buf, int len) {
+   int res = bus_wr1(buf, len), n;
+   for(n = 0; res != len && n < BNO_BUS_RETRIES; n++) {
+      bus_backoff(n);
+      res = bus_wr1(buf, len);
+   }
+   return(res);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_bus_read() reads len bytes from the current register     *
+ * address. A failed or short read may have moved the sensor's   *
+ * address pointer, so a retry sends the register address again *
+ * first. Returns the number of bytes read, like read().        *
+ * ------------------------------------------------------------ */
+int bno_bus_read(void *buf, int len) {
+   int res = bus_rd1(buf, len), n;
+   unsigned char reg = busreg;
+   for(n = 0; res != len && n < BNO_BUS_RETRIES; n++) {
+      bus_backoff(n);
+      if(bus_wr1(&reg, 1) != 1) continue;
+      res = bus_rd1(buf, len);
+   }
+   return(res);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_bus_sleep() waits usec for the sensor, e.g. a mode       *
+ * switch, who is the calling function for the trace.           *
+ * ------------------------------------------------------------ */
+void bno_bus_sleep(int usec, const char *who) {
+   int64_t t0 = bno_trace_now();
+   usleep(usec);
+   int64_t t1 = bno_trace_now();
+   bno_busstat.sleepns += t1 - t0;
+   if(bno_trace_on == 1) bno_trace_add(BNO_TR_SLEEP, 0, buspage, 0, usec, t0, t1, who);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_bus_close() releases the bus device                      *
+ * ------------------------------------------------------------ */
+void bno_bus_close() {
+   bus->close();
+}
+
+/* ------------------------------------------------------------ *
+ * bno_bus_reopen() closes and opens the bus device again, to   *
+ * clear a driver or adapter state that retries do not fix.     *
+ * ------------------------------------------------------------ */
+int bno_bus_reopen() {
+   if(bno_debug == 1) printf("Debug: Bus reopen [%s] sensor [0x%02X]\n", busdev, busaddr);
+   bus->close();
+   busreg = 0;
+   buspage = 0;
+   return(bus->open(busdev, busaddr));
+}
+
+/* ------------------------------------------------------------ *
+ * bno_bus_metrics() writes the counters in the Prometheus text *
+ * exposition format, labeled with the bus device and address.  *
+ * ------------------------------------------------------------ */
+void bno_bus_metrics(FILE *fp) {
+   static const struct {
+      const char *name, *type, *help;
+      size_t off;
+      double scale;
+   } m[] = {
+      { "transactions_total", "counter", "Bus read and write transactions", offsetof(struct bnostats, xfers), 1 },
+      { "read_bytes_total", "counter", "Bytes read from the sensor", offsetof(struct bnostats, rdbytes), 1 },
+      { "written_bytes_total", "counter", "Bytes written to the sensor, incl. register address", offsetof(struct bnostats, wrbytes), 1 },
+      { "page_switches_total", "counter", "Writes to the PAGE_ID register", offsetof(struct bnostats, pages), 1 },
+      { "mode_switches_total", "counter", "Writes to the OPR_MODE register", offsetof(struct bnostats, modes), 1 },
+      { "read_errors_total", "counter", "Failed or short reads", offsetof(struct bnostats, rderr), 1 },
+      { "write_errors_total", "counter", "Failed or short writes", offsetof(struct bnostats, wrerr), 1 },
+      { "retries_total", "counter", "Repeated transfers after an error", offsetof(struct bnostats, retries), 1 },
+      { "busy_seconds_total", "counter", "Time spent in bus transfers", offsetof(struct bnostats, busyns), 1e-9 },
+      { "sleep_seconds_total", "counter", "Time spent waiting for the sensor", offsetof(struct bnostats, sleepns), 1e-9 },
+   };
+   unsigned int i;
+
+   for(i = 0; i < sizeof(m) / sizeof(m[0]); i++) {
+      uint64_t v = *(uint64_t *) ((char *) &bno_busstat + m[i].off);
+      fprintf(fp, "# HELP bno055_bus_%s %s\n", m[i].name, m[i].help);
+      fprintf(fp, "# TYPE bno055_bus_%s %s\n", m[i].name, m[i].type);
+      if(m[i].scale == 1)
+         fprintf(fp, "bno055_bus_%s{dev=\"%s\",addr=\"0x%02x\"} %llu\n",
+                 m[i].name, busdev, busaddr, (unsigned long long) v);
+      else
+         fprintf(fp, "bno055_bus_%s{dev=\"%s\",addr=\"0x%02x\"} %.6f\n",
+                 m[i].name, busdev, busaddr, v * m[i].scale);
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * bno_bus_metrics_file() replaces file with the current        *
+ * metrics at most once per second, through "<file>.tmp" and    *
+ * rename(), for the node_exporter textfile collector.          *
+ * Returns 0, -1 on error                                       *
+ * ------------------------------------------------------------ */
+int bno_bus_metrics_file(char *file) {
+   static int64_t last = 0;
+   char tmpfile[280];
+   int64_t now = bno_trace_now();
+
+   if(last != 0 && now - last < 1000000000) return(0);
+   last = now;
+
+   snprintf(tmpfile, sizeof(tmpfile), "%s.tmp", file);
+   FILE *fp = fopen(tmpfile, "w");
+   if(fp == NULL) return(-1);
+   bno_bus_metrics(fp);
+   if(fclose(fp) != 0) return(-1);
+   return(rename(tmpfile, file));
+}
+
+/* ------------------------------------------------------------ *
+ * bno_bus_report() prints the counters, the bus busy share     *
+ * over secs, and how many sensors like this one fit on the bus *
+ * at a rate of hz samples per second.                          *
+ * ------------------------------------------------------------ */
+void bno_bus_report(FILE *fp, double secs, unsigned long samples, double hz) {
+   struct bnostats *b = &bno_busstat;
+   fprintf(fp, "Bus device [%s] sensor [0x%02X] transport [%s]\n", busdev, busaddr, bus->name);
+   fprintf(fp, "   Transactions = %llu\n", (unsigned long long) b->xfers);
+   fprintf(fp, "     Bytes read = %llu\n", (unsigned long long) b->rdbytes);
+   fprintf(fp, "  Bytes written = %llu\n", (unsigned long long) b->wrbytes);
+   fprintf(fp, "  Page switches = %llu\n", (unsigned long long) b->pages);
+   fprintf(fp, "  Mode switches = %llu\n", (unsigned long long) b->modes);
+   fprintf(fp, "   Failed reads = %llu\n", (unsigned long long) b->rderr);
+   fprintf(fp, "  Failed writes = %llu\n", (unsigned long long) b->wrerr);
+   fprintf(fp, "        Retries = %llu\n", (unsigned long long) b->retries);
+   fprintf(fp, "       Bus time = %.3f ms\n", b->busyns / 1e6);
+   fprintf(fp, "     Sleep time = %.3f ms\n", b->sleepns / 1e6);
+   if(secs <= 0 || samples == 0) return;
+
+   double persample = b->busyns / 1e9 / samples;
+   fprintf(fp, "        Samples = %lu in %.3f s, %.1f us bus time per sample\n",
+           samples, secs, persample * 1e6);
+   fprintf(fp, "Bus utilization = %.2f%%\n", 100.0 * b->busyns / 1e9 / secs);
+   if(hz > 0 && persample > 0)
+      fprintf(fp, "   Bus capacity = %d sensors at %.0f Hz\n", (int) (1.0 / (persample * hz)), hz);
+}
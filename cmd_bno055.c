@@ -0,0 +1,283 @@
+/* ------------------------------------------------------------ *
+ * file:        cmd_bno055.c                                    *
+ * purpose:     Batch commands, "-e". A sequence of commands    *
+ *              runs in one process, over the bus device that   *
+ *              is already open, instead of one getbno055 call  *
+ *              per step that opens the bus and probes the chip *
+ *              again. The operations mode is cached: a mode    *
+ *              command to the current mode costs no transfer,  *
+ *              and reads of fusion data are checked against it.*
+ *              Commands are separated by ';' or new lines, '#' *
+ *              starts a comment. The first failure stops the   *
+ *              batch. With "-e -" the commands come from stdin.*
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "getbno055.h"
+
+/* ------------------------------------------------------------ *
+ * Cached sensor state, -1 = not known yet                      *
+ * ------------------------------------------------------------ */
+static struct {
+   int mode;                         // operations mode
+   int unitsel;                      // UNIT_SEL register 0x3B
+   int fmt;                          // output format, outfmt_t
+   int khz;                          // bus clock for the read plans
+   unsigned long count;              // commands executed
+} cmd = { -1, -1, fmt_txt, BNO_PLAN_KHZ, 0 };
+
+/* ------------------------------------------------------------ *
+ * cmd_getmode() returns the cached mode, read once if unknown  *
+ * ------------------------------------------------------------ */
+static int cmd_getmode() {
+   if(cmd.mode < 0) cmd.mode = bno_get_mode();
+   return(cmd.mode);
+}
+
+static int cmd_mode(char *arg) {
+   int mode = bno_get_modecode(arg);
+   if(mode < 0) {
+      printf("Error: invalid operations mode %s.\n", arg);
+      return(-1);
+   }
+   if(mode == cmd_getmode()) {
+      if(verbose == 1) printf("Debug: Sensor already in mode %s [0x%02X].\n", arg, mode);
+      return(0);
+   }
+   cmd.mode = -1;
+   if(bno_set_mode(mode) != 0) return(-1);
+   cmd.mode = mode;
+   return(0);
+}
+
+static int cmd_power(char *arg) {
+   int pwr = bno_get_pwrcode(arg);
+   if(pwr < 0) {
+      printf("Error: invalid power mode %s.\n", arg);
+      return(-1);
+   }
+   if(pwr == bno_get_power()) return(0);
+   return(bno_set_power(pwr));
+}
+
+static int cmd_clock(char *arg) {
+   if(strcmp(arg, "ext") != 0 && strcmp(arg, "int") != 0) {
+      printf("Error: invalid clock source %s.\n", arg);
+      return(-1);
+   }
+   int ext = (strcmp(arg, "ext") == 0);
+   if(bno_get_clksrc() == ext) return(0);
+   return(bno_set_clksrc(ext));
+}
+
+static int cmd_load(char *arg) {
+   return(bno_load_cal(arg));
+}
+
+static int cmd_save(char *arg) {
+   struct bnocal bnoc;
+   if(bno_get_calstatus(&bnoc) != 0) return(-1);
+   if(bnoc.scal_st != 3) {
+      printf("Error: Sensor not fully calibrated, abort writing to file %s.\n", arg);
+      return(-1);
+   }
+   return(bno_save_cal(arg));
+}
+
+static int cmd_reset(char *arg) {
+   cmd.mode = -1;
+   cmd.unitsel = -1;
+   if(bno_reset() != 0) return(-1);
+   cmd.mode = BNO_MODE_CONFIG;
+   return(0);
+}
+
+static int cmd_sleep(char *arg) {
+   int ms = atoi(arg);
+   if(ms <= 0) {
+      printf("Error: invalid sleep time %s.\n", arg);
+      return(-1);
+   }
+   bno_bus_sleep(ms * 1000, "batch");
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * cmd_read() reads a comma separated list of data types, e.g.  *
+ * "eul,qua,temp", with the read plan of the least bus time and *
+ * prints them with -F format                                   *
+ * ------------------------------------------------------------ */
+static int cmd_read(char *arg) {
+   struct bnoplan plan;
+   int mask = bno_plan_mask(arg);
+   if(mask < 0) return(-1);
+   if((mask & ~(BNO_CH_ACC | BNO_CH_MAG | BNO_CH_GYR | BNO_CH_TMP)) && cmd_getmode() < BNO_MODE_IMU) {
+      printf("Error: sensor mode %d is not a fusion mode.\n", cmd.mode);
+      return(-1);
+   }
+   if(cmd.unitsel < 0 && (cmd.unitsel = bno_get_unit()) < 0) return(-1);
+   if(bno_plan(&plan, mask, cmd.khz) != 0) return(-1);
+   if(verbose == 1) print_plan(&plan, stdout);
+
+   struct bnoraw bnor;
+   struct bnosample bnos;
+   if(bno_get_plan(&plan, &bnor) != 0) return(-1);
+   bno_raw_to_sample(&bnor, &bnos, cmd.unitsel);
+   print_sample(&bnos, cmd.fmt, stdout);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * cmd_status() prints mode, system status, error and the       *
+ * calibration states. CALIB_STAT comes with the gravity data,  *
+ * the system status registers with a second burst.             *
+ * ------------------------------------------------------------ */
+static int cmd_status(char *arg) {
+   struct bnoraw bnor;
+   if(bno_get_raw(&bnor, BNO_CH_GRA | BNO_RAW_STATUS | BNO_RAW_CALIB) != 0) return(-1);
+   cmd.mode = bnor.oprmode;
+   printf("STA mode 0x%02X sys 0x%02X err 0x%02X cal S:%d G:%d A:%d M:%d\n",
+          bnor.oprmode, bnor.sysstat, bnor.syserr, (bnor.calstat >> 6) & 3,
+          (bnor.calstat >> 4) & 3, (bnor.calstat >> 2) & 3, bnor.calstat & 3);
+   return(0);
+}
+
+static int cmd_dump(char *arg) {
+   struct bnoregs regs;
+   if(bno_dump(&regs) != 0) return(-1);
+   print_regs(&regs, NULL, cmd.fmt, stdout);
+   return(0);
+}
+
+static int cmd_snapshot(char *arg) {
+   struct bnoregs regs;
+   FILE *fp;
+   if(bno_snapshot(&regs) != 0) return(-1);
+   if(! (fp = fopen(arg, "w"))) {
+      printf("Error: Can't open %s for writing.\n", arg);
+      return(-1);
+   }
+   print_regs(&regs, NULL, fmt_bin, fp);
+   if(fclose(fp) != 0) {
+      printf("Error: write failure for snapshot file %s.\n", arg);
+      return(-1);
+   }
+   return(0);
+}
+
+static int cmd_restore(char *arg) {
+   struct bnoregs regs;
+   FILE *fp;
+   if(! (fp = fopen(arg, "r"))) {
+      printf("Error: Can't open %s for reading.\n", arg);
+      return(-1);
+   }
+   int res = read_regs(fp, &regs);
+   fclose(fp);
+   if(res != 0) {
+      printf("Error: %s is not a register map snapshot.\n", arg);
+      return(-1);
+   }
+   cmd.mode = -1;
+   cmd.unitsel = -1;
+   if(bno_restore(&regs) < 0) return(-1);
+   cmd.mode = regs.page[0][BNO055_OPR_MODE_ADDR] & 0x0F;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * Command table: name, 1 if it needs an argument, handler      *
+ * ------------------------------------------------------------ */
+static const struct bnocmd {
+   char *name;
+   int  arg;
+   int  (*fn)(char*);
+} cmds[] = {
+   { "mode",     1, cmd_mode },
+   { "power",    1, cmd_power },
+   { "clock",    1, cmd_clock },
+   { "load",     1, cmd_load },
+   { "save",     1, cmd_save },
+   { "reset",    0, cmd_reset },
+   { "sleep",    1, cmd_sleep },
+   { "read",     1, cmd_read },
+   { "status",   0, cmd_status },
+   { "dump",     0, cmd_dump },
+   { "snapshot", 1, cmd_snapshot },
+   { "restore",  1, cmd_restore }
+};
+
+/* ------------------------------------------------------------ *
+ * cmd_exec() runs one command line, without separators. Blank  *
+ * lines and comments are no commands. Returns 0 or -1.         *
+ * ------------------------------------------------------------ */
+static int cmd_exec(char *line) {
+   char buf[1024];
+   char *p = buf, *arg, *end;
+   unsigned int i;
+
+   snprintf(buf, sizeof(buf), "%s", line);
+   if((end = strchr(buf, '#')) != NULL) *end = '\0';
+   while(isspace((unsigned char) *p)) p++;
+   if(*p == '\0') return(0);
+   end = p + strlen(p);
+   while(end > p && isspace((unsigned char) end[-1])) *--end = '\0';
+
+   for(arg = p; *arg != '\0' && ! isspace((unsigned char) *arg); arg++);
+   if(*arg != '\0') *arg++ = '\0';
+   while(isspace((unsigned char) *arg)) arg++;
+
+   for(i = 0; i < sizeof(cmds) / sizeof(cmds[0]); i++) {
+      if(strcmp(p, cmds[i].name) != 0) continue;
+      if((cmds[i].arg == 1) != (*arg != '\0')) {
+         printf("Error: command %s %s an argument.\n", p, cmds[i].arg ? "needs" : "takes no");
+         return(-1);
+      }
+      if(verbose == 1) printf("Debug: Batch command %lu: %s %s\n", cmd.count + 1, p, arg);
+      cmd.count++;
+      return(cmds[i].fn(arg));
+   }
+   printf("Error: unknown command %s.\n", p);
+   return(-1);
+}
+
+/* ------------------------------------------------------------ *
+ * cmd_run() runs the commands of the -e argument, or reads     *
+ * them line by line from stdin for "-". fmt is the -F format,  *
+ * khz the bus clock. Returns 0, or -1 after the first failure. *
+ * ------------------------------------------------------------ */
+int cmd_run(char *script, int fmt, int khz) {
+   int64_t t0 = bno_trace_now();
+   uint64_t x0 = bno_busstat.xfers;
+   char line[1024];
+   char *tok, *save = NULL;
+   int res = 0;
+   cmd.fmt = fmt;
+   cmd.khz = khz;
+
+   if(strcmp(script, "-") == 0) {
+      while(res == 0 && fgets(line, sizeof(line), stdin) != NULL) {
+         line[strcspn(line, "\r\n")] = '\0';
+         for(tok = strtok_r(line, ";", &save); res == 0 && tok != NULL; tok = strtok_r(NULL, ";", &save))
+            if((res = cmd_exec(tok)) != 0) printf("Error: command [%s] failed.\n", tok + strspn(tok, " \t"));
+         fflush(stdout);
+      }
+   }
+   else {
+      char *buf = strdup(script);
+      if(buf == NULL) return(-1);
+      for(tok = strtok_r(buf, ";\n", &save); res == 0 && tok != NULL; tok = strtok_r(NULL, ";\n", &save))
+         if((res = cmd_exec(tok)) != 0) printf("Error: command [%s] failed.\n", tok + strspn(tok, " \t"));
+      free(buf);
+   }
+   if(verbose == 1) printf("Debug: Batch of %lu commands in %.1f ms, %llu bus transfers\n",
+                           cmd.count, (bno_trace_now() - t0) / 1e6,
+                           (unsigned long long) (bno_busstat.xfers - x0));
+   return(res);
+}
@@ -0,0 +1,154 @@
+/* ------------------------------------------------------------ *
+ * file:        drift_bno055.c                                  *
+ * purpose:     Sensor clock drift estimation for the samples   *
+ *              of the continuous mode. The BNO055 updates its  *
+ *              fusion output from its own oscillator, which    *
+ *              drifts against the host clock. Each data change *
+ *              bounds the update time between the start of the *
+ *              previous read and the end of the current read.  *
+ *              A line fit over these bounds gives the sensor   *
+ *              update period and phase in host time, and the   *
+ *              sample time is corrected to its update instant. *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "getbno055.h"
+
+#define DRIFT_REBASE   100000 // shift the fit origin every n updates
+
+/* ------------------------------------------------------------ *
+ * Estimator state. Times are nsec relative to base, as double. *
+ * ------------------------------------------------------------ */
+static struct {
+   int64_t base;                     // fit origin, host monotonic
+   int64_t prevt0;                   // start of the previous read
+   int64_t k;                        // update number of the last obs
+   double tlast;                     // time of the last observation
+   double period;                    // update period in nsec
+   double phase;                     // time of update 0 in nsec
+   double sw, sk, st, skk, skt;      // weighted sums of the fit
+   double jitter;                    // mean abs residual in nsec
+   unsigned long nobs;               // observations since reset
+   unsigned long resets;             // model losses
+} dr = { .period = 1e9 / BNO_FUSION_HZ };
+
+/* ------------------------------------------------------------ *
+ * drift_reset() restarts the fit with observation t as update 0*
+ * ------------------------------------------------------------ */
+static void drift_reset(int64_t t) {
+   double period = dr.period;
+   unsigned long resets = dr.resets;
+   int64_t prevt0 = dr.prevt0;
+
+   memset(&dr, 0, sizeof(dr));
+   dr.period = period;
+   dr.resets = resets;
+   dr.prevt0 = prevt0;
+   dr.base = t;
+}
+
+/* ------------------------------------------------------------ *
+ * drift_rebase() moves the fit origin to update K, to keep the *
+ * sums small and precise in recordings of several days.        *
+ * ------------------------------------------------------------ */
+static void drift_rebase() {
+   double K = dr.k, T = llround(K * dr.period);
+
+   dr.skk = dr.skk - 2 * K * dr.sk + K * K * dr.sw;
+   dr.skt = dr.skt - K * dr.st;
+   dr.sk  = dr.sk - K * dr.sw;
+   dr.skt = dr.skt - T * dr.sk;
+   dr.st  = dr.st - T * dr.sw;
+   dr.base += T;
+   dr.tlast -= T;
+   dr.phase -= T - K * dr.period;
+   dr.k = 0;
+}
+
+/* ------------------------------------------------------------ *
+ * drift_update() is called after every read, fresh = 1 if the  *
+ * data changed. Fresh reads feed the fit, and once the model   *
+ * is settled, r->ts is set to the modelled update time. It     *
+ * returns the update time in host monotonic nsec, or the end   *
+ * of the read while there is no model yet.                     *
+ * ------------------------------------------------------------ */
+int64_t drift_update(struct bnoraw *r, int fresh) {
+   int64_t prevt0 = dr.prevt0;
+   dr.prevt0 = r->t0;
+   if(fresh == 0 || prevt0 == 0) return(r->t1);
+
+   /* -------------------------------------------------------- *
+    * The update happened within [previous t0, t1], only tight *
+    * bounds are used, with a weight of 1 / width^2 in msec    *
+    * -------------------------------------------------------- */
+   double width = r->t1 - prevt0;
+   if(width > dr.period / 2) return(r->t1);
+   double t = (prevt0 + r->t1) / 2.0;
+   double w = 1e12 / (width * width + 1e6);
+
+   if(dr.nobs == 0) drift_reset(llround(t));
+   t -= dr.base;
+
+   int64_t k = dr.k;
+   if(dr.nobs > 0) {
+      int64_t dk = llround((t - dr.tlast) / dr.period);
+      k += dk < 1 ? 1 : dk;
+   }
+
+   /* -------------------------------------------------------- *
+    * A settled model that misses by half a period is lost,    *
+    * e.g. after a sensor reset or a mode change: start again  *
+    * -------------------------------------------------------- */
+   if(dr.nobs >= BNO_DRIFT_MINOBS) {
+      double res = t - (dr.phase + k * dr.period);
+      if(fabs(res) > dr.period / 2) {
+         if(verbose == 1) printf("Debug: Sensor clock model lost, residual [%.3f ms]\n", res / 1e6);
+         dr.resets++;
+         drift_reset(llround(t + dr.base));
+         t = 0;
+         k = 0;
+      }
+      else dr.jitter += (fabs(res) - dr.jitter) / 64;
+   }
+
+   dr.sw  = BNO_DRIFT_FORGET * dr.sw  + w;
+   dr.sk  = BNO_DRIFT_FORGET * dr.sk  + w * k;
+   dr.st  = BNO_DRIFT_FORGET * dr.st  + w * t;
+   dr.skk = BNO_DRIFT_FORGET * dr.skk + w * k * k;
+   dr.skt = BNO_DRIFT_FORGET * dr.skt + w * k * t;
+   dr.k = k;
+   dr.tlast = t;
+   dr.nobs++;
+
+   double det = dr.sw * dr.skk - dr.sk * dr.sk;
+   if(dr.nobs >= 2 && det > 0) {
+      dr.period = (dr.sw * dr.skt - dr.sk * dr.st) / det;
+      dr.phase = (dr.st - dr.period * dr.sk) / dr.sw;
+   }
+   if(dr.k >= DRIFT_REBASE) drift_rebase();
+   if(dr.nobs < BNO_DRIFT_MINOBS) return(r->t1);
+
+   /* -------------------------------------------------------- *
+    * Move the host time stamp to the modelled update instant  *
+    * -------------------------------------------------------- */
+   int64_t upd = dr.base + llround(dr.phase + dr.k * dr.period);
+   int64_t ns = (int64_t) r->ts.tv_sec * 1000000000 + r->ts.tv_nsec + upd - r->t1;
+   r->ts.tv_sec = ns / 1000000000;
+   r->ts.tv_nsec = ns % 1000000000;
+   return(upd);
+}
+
+/* ------------------------------------------------------------ *
+ * drift_report() prints the sensor clock model                 *
+ * ------------------------------------------------------------ */
+void drift_report(FILE *fp) {
+   if(dr.nobs < BNO_DRIFT_MINOBS) return;
+   double nominal = 1e9 / BNO_FUSION_HZ;
+   fprintf(fp, "Sensor clock: update period %.6f ms, drift %+.0f ppm, jitter %.3f ms, %lu resets\n",
+           dr.period / 1e6, (dr.period / nominal - 1.0) * 1e6, dr.jitter / 1e6, dr.resets);
+}
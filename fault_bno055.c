@@ -0,0 +1,230 @@
+/* ------------------------------------------------------------ *
+ * file:        fault_bno055.c                                  *
+ * purpose:     Fault injection around any bus backend, "-j".   *
+ *              The wrapper passes the transfers through to the *
+ *              i2c-dev device or the simulated sensor, and     *
+ *              injects faults with the given probabilities per *
+ *              transfer, or periodically:                      *
+ *                                                              *
+ *              err=p        transfer fails, like a NACK        *
+ *              short=p      read returns only half the bytes   *
+ *              spike=p:ms   transfer is delayed by ms          *
+ *              corrupt=p    one bit of the read data flips     *
+ *              stuck=s:ms   every s seconds, all transfers     *
+ *                           fail for ms, like a stuck SDA line *
+ *              reset=s      every s seconds, the sensor gets a *
+ *                           reset and comes up in CONFIG mode  *
+ *              config=s     every s seconds, the sensor drops  *
+ *                           to CONFIG mode, but keeps running  *
+ *              syserr=s     every s seconds, the sensor reports*
+ *                           a system error until it is reset   *
+ *              seed=n       random seed, for repeatable runs   *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+#include "getbno055.h"
+
+int bno_fault_on = 0;        // 1 = wrap the backend, set by bno_fault_init()
+
+/* ------------------------------------------------------------ *
+ * Fault configuration, injection counters and random state     *
+ * ------------------------------------------------------------ */
+static struct {
+   const struct bnobus *inner;       // wrapped backend
+   double err, shrt, spike, corrupt; // probabilities per transfer
+   int spikems;                      // delay of a latency spike
+   double stuck;                     // stuck bus period in sec
+   int stuckms;                      // stuck bus duration
+   double reset;                     // sensor reset period in sec
+   double config;                    // drop to CONFIG period in sec
+   double syserr;                    // system error period in sec
+   uint64_t rnd;                     // xorshift64 state
+   int64_t start;                    // time of bno_fault_wrap()
+   int64_t nextstuck, nextreset;     // due times of periodic faults
+   int64_t nextconfig, nextsyserr;
+   int64_t stuckend;                 // end of the current stuck window
+   int errflag;                      // 1 = reporting a system error
+   int addr;                         // register address pointer
+   unsigned long n_err, n_short, n_spike, n_corrupt, n_stuck, n_reset;
+   unsigned long n_config, n_syserr;
+} ft;
+
+/* ------------------------------------------------------------ *
+ * fault_rand() returns a uniform random number in [0, 1)       *
+ * ------------------------------------------------------------ */
+static double fault_rand() {
+   ft.rnd ^= ft.rnd << 13;
+   ft.rnd ^= ft.rnd >> 7;
+   ft.rnd ^= ft.rnd << 17;
+   return((ft.rnd >> 11) * (1.0 / 9007199254740992.0));
+}
+
+/* ------------------------------------------------------------ *
+ * bno_fault_init() parses the -j spec, "key=value,..." as      *
+ * listed above. Returns 0, or -1 for an invalid spec.          *
+ * ------------------------------------------------------------ */
+int bno_fault_init(char *spec) {
+   char buf[256];
+   char *tok, *save = NULL;
+   ft.rnd = time(NULL) | 1;
+
+   if(strlen(spec) >= sizeof(buf)) return(-1);
+   strcpy(buf, spec);
+   for(tok = strtok_r(buf, ",", &save); tok != NULL; tok = strtok_r(NULL, ",", &save)) {
+      char *val = strchr(tok, '=');
+      if(val == NULL) return(-1);
+      *val++ = '\0';
+      int n = 0;
+      if(strcmp(tok, "err") == 0)          n = sscanf(val, "%lf", &ft.err);
+      else if(strcmp(tok, "short") == 0)   n = sscanf(val, "%lf", &ft.shrt);
+      else if(strcmp(tok, "spike") == 0)   n = sscanf(val, "%lf:%d", &ft.spike, &ft.spikems) - 1;
+      else if(strcmp(tok, "corrupt") == 0) n = sscanf(val, "%lf", &ft.corrupt);
+      else if(strcmp(tok, "stuck") == 0)   n = sscanf(val, "%lf:%d", &ft.stuck, &ft.stuckms) - 1;
+      else if(strcmp(tok, "reset") == 0)   n = sscanf(val, "%lf", &ft.reset);
+      else if(strcmp(tok, "config") == 0)  n = sscanf(val, "%lf", &ft.config);
+      else if(strcmp(tok, "syserr") == 0)  n = sscanf(val, "%lf", &ft.syserr);
+      else if(strcmp(tok, "seed") == 0) {
+         n = sscanf(val, "%" SCNu64, &ft.rnd);
+         ft.rnd = ft.rnd * 2654435761u + 1;
+      }
+      if(n != 1) {
+         printf("Error: invalid fault injection setting [%s].\n", tok);
+         return(-1);
+      }
+   }
+   if(ft.err < 0 || ft.shrt < 0 || ft.spike < 0 || ft.corrupt < 0
+      || ft.spikems < 0 || ft.stuck < 0 || ft.stuckms < 0 || ft.reset < 0
+      || ft.config < 0 || ft.syserr < 0) return(-1);
+   bno_fault_on = 1;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * fault_pre() runs before each transfer: the periodic faults   *
+ * and the latency spikes. Returns -1 if the transfer fails.    *
+ * ------------------------------------------------------------ */
+static int fault_pre() {
+   int64_t now = bno_trace_now();
+
+   if(ft.reset > 0 && now >= ft.nextreset) {
+      unsigned char rst[2] = { BNO055_SYS_TRIGGER_ADDR, 0x20 };
+      ft.nextreset += ft.reset * 1e9;
+      ft.n_reset++;
+      ft.inner->write(rst, 2);
+   }
+   if(ft.config > 0 && now >= ft.nextconfig) {
+      unsigned char cfg[2] = { BNO055_OPR_MODE_ADDR, BNO_MODE_CONFIG };
+      ft.nextconfig += ft.config * 1e9;
+      ft.n_config++;
+      ft.inner->write(cfg, 2);
+   }
+   if(ft.syserr > 0 && now >= ft.nextsyserr) {
+      ft.nextsyserr += ft.syserr * 1e9;
+      ft.n_syserr++;
+      ft.errflag = 1;
+   }
+   if(ft.stuck > 0 && now >= ft.nextstuck) {
+      ft.nextstuck += ft.stuck * 1e9;
+      ft.stuckend = now + (int64_t) ft.stuckms * 1000000;
+      ft.n_stuck++;
+   }
+   if(now < ft.stuckend) return(-1);
+
+   if(ft.spike > 0 && fault_rand() < ft.spike) {
+      struct timespec ts = { ft.spikems / 1000, (ft.spikems % 1000) * 1000000L };
+      ft.n_spike++;
+      nanosleep(&ts, NULL);
+   }
+   if(ft.err > 0 && fault_rand() < ft.err) {
+      ft.n_err++;
+      return(-1);
+   }
+   return(0);
+}
+
+static int fault_open(const char *dev, int addr) {
+   return(ft.inner->open(dev, addr));
+}
+
+/* ------------------------------------------------------------ *
+ * fault_write() follows the register address pointer, and a    *
+ * reset clears the system error.                               *
+ * ------------------------------------------------------------ */
+static int fault_write(const void *buf, int len) {
+   const unsigned char *p = buf;
+   if(fault_pre() != 0) return(-1);
+   int res = ft.inner->write(buf, len);
+   if(res < 1) return(res);
+   ft.addr = p[0];
+   if(len > 1 && p[0] == BNO055_SYS_TRIGGER_ADDR && (p[1] & 0x20)) ft.errflag = 0;
+   return(res);
+}
+
+static int fault_read(void *buf, int len) {
+   if(fault_pre() != 0) return(-1);
+   int res = ft.inner->read(buf, len);
+   if(res <= 0) return(res);
+
+   if(ft.shrt > 0 && len > 1 && fault_rand() < ft.shrt) {
+      ft.n_short++;
+      return(len / 2);
+   }
+   if(ft.corrupt > 0 && fault_rand() < ft.corrupt) {
+      int bit = fault_rand() * res * 8;
+      ((unsigned char *) buf)[bit / 8] ^= 1 << (bit % 8);
+      ft.n_corrupt++;
+   }
+   /* -------------------------------------------------------- *
+    * A system error shows in SYS_STATUS 0x39 and SYS_ERR      *
+    * 0x3A, here as 0x06 "register map write error"            *
+    * -------------------------------------------------------- */
+   if(ft.errflag == 1) {
+      int i;
+      for(i = 0; i < res; i++) {
+         if(ft.addr + i == BNO055_SYS_STAT_ADDR) ((unsigned char *) buf)[i] = 0x01;
+         if(ft.addr + i == BNO055_SYS_ERR_ADDR) ((unsigned char *) buf)[i] = 0x06;
+      }
+   }
+   return(res);
+}
+
+static void fault_close() {
+   ft.inner->close();
+}
+
+static const struct bnobus faultbus = {
+   "fault", fault_open, fault_write, fault_read, fault_close
+};
+
+/* ------------------------------------------------------------ *
+ * bno_fault_wrap() returns the fault injecting backend around  *
+ * the inner one, periodic faults start one period from now.    *
+ * ------------------------------------------------------------ */
+const struct bnobus *bno_fault_wrap(const struct bnobus *inner) {
+   ft.inner = inner;
+   ft.start = bno_trace_now();
+   ft.nextstuck = ft.start + ft.stuck * 1e9;
+   ft.nextreset = ft.start + ft.reset * 1e9;
+   ft.nextconfig = ft.start + ft.config * 1e9;
+   ft.nextsyserr = ft.start + ft.syserr * 1e9;
+   return(&faultbus);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_fault_report() prints the injected faults                *
+ * ------------------------------------------------------------ */
+void bno_fault_report(FILE *fp) {
+   if(bno_fault_on == 0) return;
+   fprintf(fp, "Faults injected: %lu errors, %lu short reads, %lu spikes, %lu corrupted, %lu stuck, "
+           "%lu resets, %lu config, %lu syserr\n", ft.n_err, ft.n_short, ft.n_spike, ft.n_corrupt,
+           ft.n_stuck, ft.n_reset, ft.n_config, ft.n_syserr);
+   fprintf(fp, "Bus transfers: %llu, %llu failed reads, %llu failed writes, %llu retries\n",
+           (unsigned long long) bno_busstat.xfers, (unsigned long long) bno_busstat.rderr,
+           (unsigned long long) bno_busstat.wrerr, (unsigned long long) bno_busstat.retries);
+}
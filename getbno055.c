@@ -20,6 +20,8 @@
 #include <string.h>
 #include <getopt.h>
 #include <time.h>
+#include <signal.h>
+#include <math.h>
 #include "getbno055.h"
 
 /* ------------------------------------------------------------ *
@@ -27,25 +29,62 @@
  * ------------------------------------------------------------ */
 int verbose = 0;
 int outflag = 0;
+int outfmt = fmt_txt; // -F output format, see outfmt_t
 int argflag = 0; // 1 dump, 2 reset, 3 load calib, 4 write calib
 char opr_mode[9] = {0};
 char pwr_mode[8] = {0};
+char clk_src[4] = {0};
 char datatype[256];
 char senaddr[256] = "0x28";
 char i2c_bus[256] = I2CBUS;
 char htmfile[256];
 char calfile[256];
+char webbind[64];
+char logfile[256];
+char recfile[256];
+char tracefile[256];        // -x Chrome trace JSON output file
+char metricfile[256];       // -P Prometheus metrics text file
+char faultspec[256];        // -j fault injection settings
+int traceev = BNO_TR_EVENTS; // -x trace ring size in events
+int buskhz = 0;             // --khz bus clock for the read plan, 0 = detect
+double watchrate = 0;       // --watch -d register dump rate in Hz
+char snapfile[256];         // --snapshot register map output file
+char restfile[256];         // --restore register map input file
+char cmdscript[1024];       // -e batch commands, "-" = stdin
+char intspec[256];          // -i interrupt configuration
+char irqline[128];          // -I gpiochip:line of the INT pin
+double conrate = 0;         // -s sample rate in Hz, 0 = no pacing
+double idlerate = 0;        // -s idle sample rate, 0 = fixed rate
+int idlepwr = 0;            // -s 1 = sensor low power mode when idle
+int keepdup = 0;            // -D 1 = keep reads with unchanged data
+int rtprio = 0;             // -T SCHED_FIFO priority, 0 = normal
+int rtcpu = -1;             // -T CPU to pin the loop to, -1 = any
+int recpre = BNO_REC_PRE;   // -f seconds kept before a trigger
+int recpost = BNO_REC_POST; // -f seconds saved after a trigger
+double recthres = 0;        // -g trigger acceleration in m/s^2
+volatile sig_atomic_t stopflag = 0; // set by SIGINT/SIGTERM in -t con
+volatile sig_atomic_t histflag = 0; // set by SIGUSR1, dump histograms
 
 /* ------------------------------------------------------------ *
  * print_usage() prints the programs commandline instructions.  *
  * ------------------------------------------------------------ */
 void usage() {
-   static char const usage[] = "Usage: getbno055 [-a hex i2c-addr] [-m <opr_mode>] [-t acc|gyr|mag|eul|qua|lin|gra|inf|cal|con] [-r] [-w calfile] [-l calfile] [-o htmlfile] [-v]\n\
+   static char const usage[] = "Usage: getbno055 [-a hex i2c-addr] [-e commands|-] [-d [--watch Hz]] [--snapshot|--restore file] [-m <opr_mode>] [-c ext|int] [-t acc|gyr|mag|eul|qua|lin|gra|temp[,type...]|inf|cal|int|stats|con] [--khz kHz] [-r] [-w calfile] [-l calfile] [-o htmlfile] [-u Hz] [-H [addr:]port] [-L logfile] [-f ringfile[:pre[:post]]] [-g m/s^2] [-i intspec] [-I chip:line|sim] [-s Hz[:idleHz[:low]]] [-D] [-T prio[:cpu]] [-x tracefile[:events]] [-P metricsfile] [-j faultspec] [-k drop|reread] [-F txt|csv|jsonl|bin] [-v]\n\
 \n\
 Command line parameters have the following format:\n\
    -a   sensor I2C bus address in hex, Example: -a 0x28 (default)\n\
    -b   I2C bus to query, Example: -b /dev/i2c-1 (default)\n\
-   -d   dump the complete sensor register map content\n\
+        sim = simulated sensor in NDOF mode with synthetic motion, no hardware needed\n\
+   -d   dump the complete sensor register map content, -F jsonl or bin for scripts\n\
+        --watch Hz: dump again at the given rate, changed bytes are highlighted\n\
+   --snapshot file: save the register map setup, incl. calibration and operations mode\n\
+   --restore file: write back the registers that differ from a snapshot, then its mode\n\
+   -e   run a batch of commands in one process, separated by ; or new lines, or\n\
+        read from stdin with -e -. Stops at the first failed command. Commands:\n\
+           mode <opr_mode>, power <pwr_mode>, clock ext|int, load <calfile>,\n\
+           save <calfile>, reset, sleep <ms>, read <type>[,type...], status,\n\
+           dump, snapshot <file>, restore <file>\n\
+        Example: -e \"mode config; load ./bno055.cal; mode ndof; read eul\"\n\
    -m   set sensor operational mode. mode arguments:\n\
            config   = configuration mode\n\
            acconly  = accelerometer only\n\
@@ -64,6 +103,9 @@ Command line parameters have the following format:\n\
           normal    = required sensors and MCU always on (default)\n\
           low       = enter sleep mode during motion inactivity\n\
           suspend   = sensor paused, all parts put to sleep\n\
+   -c   set sensor clock source, switches via CONFIG mode and verifies. arguments:\n\
+          ext       = external 32kHz crystal, e.g. on the Adafruit breakout board\n\
+          int       = internal oscillator (default)\n\
    -r   reset sensor\n\
    -t   read and output sensor data. data type arguments:\n\
            acc = Accelerometer (X-Y-Z axis values)\n\
@@ -73,12 +115,78 @@ Command line parameters have the following format:\n\
            qua = Orientation Q (W-X-Y-Z values as Quaternation)\n\
            gra = GravityVector (X-Y-Z axis values)\n\
            lin = Linear Accel (X-Y-Z axis values)\n\
+           temp = Temperature (degrees C or F as in UNIT_SEL)\n\
+           a comma separated list, e.g. acc,gyr,qua,temp, reads the types with the\n\
+           read plan of the least bus time, -v shows the plan\n\
            inf = Sensor info (23 version and state values)\n\
            cal = Calibration data (mag, gyro and accel calibration values)\n\
+           int = Interrupt configuration and status\n\
+           stats = Bus counters and capacity, from one second of reads at the -s rate\n\
            con = Continuous data (eul)\n\
+   --khz kHz: I2C bus clock for the read plan, default from the device tree or 100\n\
    -l   load sensor calibration data from file, Example -l ./bno055.cal\n\
    -w   write sensor calibration data to file, Example -w ./bno055.cal\n\
    -o   output sensor data to HTML table file, requires -t, Example: -o ./bno055.html\n\
+        a file name ending in .json gets a JSON object instead of the HTML table\n\
+   -u   max update rate of the -o file in Hz for -t con, 0 = every sample, Example: -u 1 (default)\n\
+   -H   serve live data over HTTP in -t con mode, binds to 127.0.0.1 if no addr is given\n\
+           GET /json   = latest sample as JSON object\n\
+           GET /events = Server-Sent Events stream of all samples\n\
+           GET /hist   = loop timing histograms, also on signal SIGUSR1 to stderr\n\
+           GET /metrics = bus counters in Prometheus text format\n\
+        Example: -H 8080 or -H 0.0.0.0:8080\n\
+   -L   log all data channels compressed to file in -t con mode, decode with bnolog\n\
+        Example: -L ./bno055.bnl\n\
+   -f   flight recorder in -t con mode: keep the last pre seconds of all data channels\n\
+        in a ring file, and on a trigger save pre + post seconds to ringfile.<time>.<-F>\n\
+        Triggers: -g threshold, signal SIGUSR2, or GET /trigger with -H (default 10:2)\n\
+        Example: -f ./bno055.ring:30:5\n\
+   -g   flight recorder trigger, acceleration magnitude in m/s^2, Example: -g 30\n\
+   -i   configure the motion interrupts, comma separated source:threshold[:duration]\n\
+        in register units, the sources drive the INT pin. Sources are:\n\
+           acc_am = accelerometer any-motion, threshold x 3.91mg, duration 0-3 samples\n\
+           acc_nm = accelerometer no-motion, threshold x 3.91mg, duration code 0-63\n\
+           acc_hg = accelerometer high-g, threshold x 7.81mg, duration x 2ms\n\
+           gyr_am = gyroscope any-motion, threshold 0-127 x 1dps, no duration\n\
+           gyr_hr = gyroscope high-rate, threshold 0-31 x 62.5dps, duration x 2.5ms\n\
+           off    = disable all interrupts\n\
+        Example: -i acc_am:20:1,acc_hg:192:10\n\
+   -I   in -t con mode, sleep until the INT pin signals an event on a GPIO line,\n\
+        then read one sample. Without an event for 1s, only the sensor health is\n\
+        checked. sim = INT pin of the simulated sensor. Example: -I gpiochip0:17\n\
+   -s   sample rate in Hz for -t con, default: as fast as possible. With an idle rate,\n\
+        the rate drops to it after 2s without motion (gyr and lin), and returns to\n\
+        the full rate with the first moving sample. low sets the sensor low power\n\
+        mode, the sensor then sleeps and wakes up by itself. Example: -s 100:5:low\n\
+   -D   in -t con mode, keep reads that return unchanged sensor data. By default they\n\
+        are dropped, and without -s the reads follow the 100Hz sensor data updates.\n\
+   -T   real-time mode for -t con: SCHED_FIFO priority 1-99, optionally pinned to a\n\
+        CPU, with locked memory. Needs root or CAP_SYS_NICE and CAP_IPC_LOCK.\n\
+        Example: -T 50:3\n\
+   -x   trace all bus transfers and sensor waits, written as Chrome trace JSON at exit\n\
+        for chrome://tracing or ui.perfetto.dev, keeps the last events (default 65536)\n\
+        Example: -x ./bno055.trace.json:100000\n\
+   -P   in -t con mode, write the bus counters in Prometheus text format to a file,\n\
+        replaced once per second, e.g. for the node_exporter textfile collector\n\
+        Example: -P /var/lib/node_exporter/bno055.prom\n\
+   -j   inject bus faults, comma separated, p = probability per transfer:\n\
+           err=p      transfer fails          short=p    read returns half the bytes\n\
+           spike=p:ms transfer delayed by ms  corrupt=p  one bit of read data flips\n\
+           stuck=s:ms bus fails for ms every s seconds\n\
+           reset=s    sensor reset every s seconds\n\
+           config=s   sensor drops to CONFIG mode every s seconds\n\
+           syserr=s   sensor reports a system error every s seconds, until reset\n\
+           seed=n     random seed for repeatable runs\n\
+        Example: -j err=0.01,reset=5,seed=1\n\
+   -k   in -t con mode, check each sample for values out of range, quaternion and\n\
+        gravity length, and Euler angle jumps, to catch corrupted reads:\n\
+           drop   = invalid samples are dropped\n\
+           reread = invalid samples are read once more, then dropped\n\
+   -F   output format for sensor data, applies to all -t data types, con and -d:\n\
+           txt   = text lines, e.g. EUL 66.06 -3.00 -15.56 (default)\n\
+           csv   = comma separated values with a header line\n\
+           jsonl = JSON Lines, one JSON object per sample\n\
+           bin   = length-prefixed binary frames with timestamp and channel mask\n\
    -h   display this message\n\
    -v   enable debug output\n\
 \n\
@@ -88,13 +196,122 @@ Usage examples:\n\
 ./getbno055 -a 0x28 -t inf -v\n\
 ./getbno055 -t cal -v\n\
 ./getbno055 -t eul -o ./bno055.html\n\
+./getbno055 -t con -F jsonl\n\
+./getbno055 -t con -H 8080 -F csv > /dev/null\n\
+./getbno055 -t con -L ./bno055.bnl > /dev/null\n\
+./getbno055 -t con -f ./bno055.ring -g 30 > /dev/null\n\
+./getbno055 -i acc_am:20:1\n\
+./getbno055 -t con -I gpiochip0:17\n\
+./getbno055 -t con -s 100:5\n\
+./getbno055 -t con -s 400 -T 50:3 -F bin > bno055.bin\n\
+./getbno055 -b sim -t con -x ./bno055.trace.json\n\
+./getbno055 -b sim -t con -j reset=5,seed=1 > /dev/null\n\
+./getbno055 -t stats -s 100\n\
+./getbno055 -t acc,gyr,qua,temp --khz 400 -v\n\
+./getbno055 -d --watch 2\n\
+./getbno055 -d -F jsonl\n\
+./getbno055 --snapshot ./bno055.regs\n\
+./getbno055 -e \"status; mode config; load ./bno055.cal; mode ndof; status\"\n\
 ./getbno055 -m ndof\n\
+./getbno055 -c ext\n\
 ./getbno055 -w ./bno055.cal\n";
    printf(usage);
 }
 
 /* ------------------------------------------------------------ *
- * parseargs() checks the commandline arguments with C getopt   *
+ * con_stop() signal handler ends the continuous mode loop, so  *
+ * that open log files get finished properly.                   *
+ * ------------------------------------------------------------ */
+void con_stop(int sig) {
+   stopflag = 1;
+}
+
+/* ------------------------------------------------------------ *
+ * con_hist() signal handler requests a histogram dump, the     *
+ * loop prints it to stderr between two samples.                *
+ * ------------------------------------------------------------ */
+void con_hist(int sig) {
+   histflag = 1;
+}
+
+/* ------------------------------------------------------------ *
+ * parse_intspec() sets the interrupt sources, thresholds and   *
+ * durations given as "source:thres[:dur],..." in bnoi. Values  *
+ * not given keep the sensor setting. A value outside the width *
+ * of its register field, or a duration for gyr_am that has no  *
+ * duration register, is an error. Returns -1 on bad input.     *
+ * ------------------------------------------------------------ */
+int parse_intspec(char *spec, struct bnoint *bnoi) {
+   char buf[256];
+   char *tok, *save;
+
+   strncpy(buf, spec, sizeof(buf) - 1);
+   buf[sizeof(buf) - 1] = '\0';
+   bnoi->enable = 0;
+   if(strcmp(buf, "off") == 0) {
+      bnoi->mask = 0;
+      return(0);
+   }
+   for(tok = strtok_r(buf, ",", &save); tok != NULL; tok = strtok_r(NULL, ",", &save)) {
+      char name[8];
+      int thres = 0, dur = 0, bit, tmax = 255, dmax = 255;
+      int *th, *du;
+      int n = sscanf(tok, "%7[a-z_]:%d:%d", name, &thres, &dur);
+      if(n < 1) return(-1);
+      if(strcmp(name, "acc_am") == 0) {
+         bit = BNO_INT_ACC_AM; th = &bnoi->am_thres; du = &bnoi->am_dur; dmax = 3;
+      }
+      else if(strcmp(name, "acc_nm") == 0) {
+         bit = BNO_INT_ACC_NM; th = &bnoi->nm_thres; du = &bnoi->nm_dur; dmax = 63;
+      }
+      else if(strcmp(name, "acc_hg") == 0) {
+         bit = BNO_INT_ACC_HG; th = &bnoi->hg_thres; du = &bnoi->hg_dur;
+      }
+      else if(strcmp(name, "gyr_am") == 0) {
+         bit = BNO_INT_GYR_AM; th = &bnoi->gam_thres; du = NULL; tmax = 127;
+      }
+      else if(strcmp(name, "gyr_hr") == 0) {
+         bit = BNO_INT_GYR_HR; th = &bnoi->hr_thres; du = &bnoi->hr_dur; tmax = 31;
+      }
+      else {
+         printf("Error: unknown interrupt source [%s].\n", name);
+         return(-1);
+      }
+      if(n >= 2 && (thres < 0 || thres > tmax)) {
+         printf("Error: %s threshold %d out of range 0-%d.\n", name, thres, tmax);
+         return(-1);
+      }
+      if(n == 3 && du == NULL) {
+         printf("Error: %s has no duration setting.\n", name);
+         return(-1);
+      }
+      if(n == 3 && (dur < 0 || dur > dmax)) {
+         printf("Error: %s duration %d out of range 0-%d.\n", name, dur, dmax);
+         return(-1);
+      }
+      bnoi->enable |= bit;
+      if(n >= 2) *th = thres;
+      if(n == 3) *du = dur;
+   }
+   bnoi->mask = bnoi->enable;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * Long options without a short option letter                   *
+ * ------------------------------------------------------------ */
+enum { opt_watch = 256, opt_snapshot, opt_restore, opt_khz };
+
+static const struct option longopts[] = {
+   { "watch",    required_argument, NULL, opt_watch },
+   { "snapshot", required_argument, NULL, opt_snapshot },
+   { "restore",  required_argument, NULL, opt_restore },
+   { "khz",      required_argument, NULL, opt_khz },
+   { NULL, 0, NULL, 0 }
+};
+
+/* ------------------------------------------------------------ *
+ * parseargs() checks the commandline arguments with getopt_long*
  * ------------------------------------------------------------ */
 void parseargs(int argc, char* argv[]) {
    int arg;
@@ -102,7 +319,7 @@ void parseargs(int argc, char* argv[]) {
 
    if(argc == 1) { usage(); exit(-1); }
 
-   while ((arg = (int) getopt (argc, argv, "a:b:dm:p:rt:l:w:o:hv")) != -1) {
+   while ((arg = (int) getopt_long (argc, argv, "a:b:de:m:c:p:rt:l:w:o:u:H:L:f:g:i:I:s:DT:x:P:j:k:F:hv", longopts, NULL)) != -1) {
       switch (arg) {
          // arg -v verbose, type: flag, optional
          case 'v':
@@ -137,6 +354,17 @@ void parseargs(int argc, char* argv[]) {
             argflag = 1;
             break;
 
+         // arg -e + batch commands, type: string
+         // optional, example: "mode config; load ./bno055.cal; mode ndof"
+         case 'e':
+            if(verbose == 1) printf("Debug: arg -e, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(cmdscript)) {
+               printf("Error: -e batch command argument too long.\n");
+               exit(-1);
+            }
+            strcpy(cmdscript, optarg);
+            break;
+
          // arg -m sets operations mode, type: string
          case 'm':
             if(verbose == 1) printf("Debug: arg -m, value %s\n", optarg);
@@ -147,6 +375,16 @@ void parseargs(int argc, char* argv[]) {
             strncpy(opr_mode, optarg, sizeof(opr_mode));
             break;
 
+         // arg -c sets the clock source, type: string
+         case 'c':
+            if(verbose == 1) printf("Debug: arg -c, value %s\n", optarg);
+            if(strcmp(optarg, "ext") != 0 && strcmp(optarg, "int") != 0) {
+               printf("Error: invalid clock source argument, use ext or int.\n");
+               exit(-1);
+            }
+            strcpy(clk_src, optarg);
+            break;
+
          // arg -p sets power mode, type: string
          case 'p':
             if(verbose == 1) printf("Debug: arg -p, value %s\n", optarg);
@@ -168,7 +406,7 @@ void parseargs(int argc, char* argv[]) {
          // mandatory, example: mag (magnetometer)
          case 't':
             if(verbose == 1) printf("Debug: arg -t, value %s\n", optarg);
-            if (strlen(optarg) != 3) {
+            if (strlen(optarg) < 3 || strlen(optarg) >= sizeof(datatype)) {
                printf("Error: Cannot get valid -t data type argument.\n");
                exit(-1);
             }
@@ -211,13 +449,238 @@ void parseargs(int argc, char* argv[]) {
             strncpy(htmfile, optarg, sizeof(htmfile));
             break;
 
+         // arg -u + max update rate of the -o file, type: float
+         // optional, example: 0.5 (update every 2 seconds)
+         case 'u':
+            if(verbose == 1) printf("Debug: arg -u, value %s\n", optarg);
+            htmrate = strtod(optarg, NULL);
+            if(htmrate < 0) {
+               printf("Error: invalid -u update rate argument.\n");
+               exit(-1);
+            }
+            break;
+
+         // arg -H + HTTP server bind address, type: string
+         // optional, requires -t con, example: 0.0.0.0:8080
+         case 'H':
+            if(verbose == 1) printf("Debug: arg -H, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(webbind)) {
+               printf("Error: invalid -H bind address argument.\n");
+               exit(-1);
+            }
+            strncpy(webbind, optarg, sizeof(webbind));
+            break;
+
+         // arg -L + compressed log file name, type: string
+         // optional, requires -t con, example: ./bno055.bnl
+         case 'L':
+            if(verbose == 1) printf("Debug: arg -L, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(logfile)) {
+               printf("Error: invalid logfile argument.\n");
+               exit(-1);
+            }
+            strncpy(logfile, optarg, sizeof(logfile));
+            break;
+
+         // arg -f + flight recorder ring file, type: string
+         // optional, requires -t con, example: ./bno055.ring:30:5
+         case 'f':
+            if(verbose == 1) printf("Debug: arg -f, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(recfile)) {
+               printf("Error: invalid ringfile argument.\n");
+               exit(-1);
+            }
+            strncpy(recfile, optarg, sizeof(recfile));
+            char *sep = strchr(recfile, ':');
+            if(sep != NULL) {
+               *sep = '\0';
+               if(sscanf(sep + 1, "%d:%d", &recpre, &recpost) < 1 || recpre < 0 || recpost < 0) {
+                  printf("Error: invalid -f pre:post seconds argument.\n");
+                  exit(-1);
+               }
+            }
+            break;
+
+         // arg -g + flight recorder trigger threshold, type: float
+         // optional, requires -f, example: 30 (m/s^2, about 3g)
+         case 'g':
+            if(verbose == 1) printf("Debug: arg -g, value %s\n", optarg);
+            recthres = strtod(optarg, NULL);
+            if(recthres <= 0) {
+               printf("Error: invalid -g trigger threshold argument.\n");
+               exit(-1);
+            }
+            break;
+
+         // arg -i + interrupt configuration, type: string
+         // optional, example: acc_am:20:1,acc_hg:192
+         case 'i':
+            if(verbose == 1) printf("Debug: arg -i, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(intspec)) {
+               printf("Error: invalid -i interrupt argument.\n");
+               exit(-1);
+            }
+            strncpy(intspec, optarg, sizeof(intspec));
+            break;
+
+         // arg -I + INT pin GPIO line, type: string
+         // optional, requires -t con, example: gpiochip0:17
+         case 'I':
+            if(verbose == 1) printf("Debug: arg -I, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(irqline)) {
+               printf("Error: invalid -I interrupt line argument.\n");
+               exit(-1);
+            }
+            strncpy(irqline, optarg, sizeof(irqline));
+            break;
+
+         // arg -s + sample rate[:idle rate[:low]], type: string
+         // optional, requires -t con, example: 100:5:low
+         case 's': {
+            char pwr[8] = {0};
+            if(verbose == 1) printf("Debug: arg -s, value %s\n", optarg);
+            if(sscanf(optarg, "%lf:%lf:%7s", &conrate, &idlerate, pwr) < 1
+               || conrate <= 0 || idlerate < 0 || idlerate > conrate) {
+               printf("Error: invalid -s sample rate argument.\n");
+               exit(-1);
+            }
+            if(strcmp(pwr, "low") == 0) idlepwr = 1;
+            else if(strlen(pwr) > 0) {
+               printf("Error: invalid -s power mode argument %s.\n", pwr);
+               exit(-1);
+            }
+            break;
+         }
+
+         // arg -D keep duplicate reads, type: flag, optional
+         case 'D':
+            keepdup = 1; break;
+
+         // arg -T + real-time priority[:cpu], type: string
+         // optional, requires -t con, example: 50:3
+         case 'T':
+            if(verbose == 1) printf("Debug: arg -T, value %s\n", optarg);
+            if(sscanf(optarg, "%d:%d", &rtprio, &rtcpu) < 1
+               || rtprio < 1 || rtprio > 99 || rtcpu < -1) {
+               printf("Error: invalid -T real-time priority argument.\n");
+               exit(-1);
+            }
+            break;
+
+         // arg -x + trace file[:events], type: string
+         // optional, example: ./bno055.trace.json:100000
+         case 'x':
+            if(verbose == 1) printf("Debug: arg -x, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(tracefile)) {
+               printf("Error: invalid trace file argument.\n");
+               exit(-1);
+            }
+            strncpy(tracefile, optarg, sizeof(tracefile));
+            char *evsep = strchr(tracefile, ':');
+            if(evsep != NULL) {
+               *evsep = '\0';
+               if(sscanf(evsep + 1, "%d", &traceev) != 1 || traceev < 1) {
+                  printf("Error: invalid -x trace events argument.\n");
+                  exit(-1);
+               }
+            }
+            break;
+
+         // arg -P + Prometheus metrics file, type: string
+         // optional, requires -t con, example: /var/lib/node_exporter/bno055.prom
+         case 'P':
+            if(verbose == 1) printf("Debug: arg -P, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(metricfile)) {
+               printf("Error: invalid metrics file argument.\n");
+               exit(-1);
+            }
+            strncpy(metricfile, optarg, sizeof(metricfile));
+            break;
+
+         // arg -j + fault injection settings, type: string
+         // optional, example: err=0.01,reset=5,seed=1
+         case 'j':
+            if(verbose == 1) printf("Debug: arg -j, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(faultspec) || bno_fault_init(optarg) != 0) {
+               printf("Error: invalid -j fault injection argument.\n");
+               exit(-1);
+            }
+            strcpy(faultspec, optarg);
+            break;
+
+         // arg -k + sample validation mode, type: string
+         // optional, example: reread
+         case 'k':
+            if(verbose == 1) printf("Debug: arg -k, value %s\n", optarg);
+            if(val_init(optarg) != 0) {
+               printf("Error: invalid -k validation argument.\n");
+               exit(-1);
+            }
+            break;
+
+         // arg -F + output format, type: string
+         // optional, example: jsonl
+         case 'F':
+            if(verbose == 1) printf("Debug: arg -F, value %s\n", optarg);
+            if((outfmt = get_outfmt(optarg)) < 0) {
+               printf("Error: invalid -F output format argument.\n");
+               exit(-1);
+            }
+            break;
+
+         // arg --watch + dump rate in Hz, type: double
+         // optional, with -d, example: 2
+         case opt_watch:
+            if(verbose == 1) printf("Debug: arg --watch, value %s\n", optarg);
+            watchrate = strtod(optarg, NULL);
+            if(watchrate <= 0 || watchrate > 100) {
+               printf("Error: invalid --watch rate argument.\n");
+               exit(-1);
+            }
+            break;
+
+         // arg --snapshot + register map file, type: string
+         // optional, example: ./bno055.regs
+         case opt_snapshot:
+            if(verbose == 1) printf("Debug: arg --snapshot, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(snapfile)) {
+               printf("Error: snapshot filename too long.\n");
+               exit(-1);
+            }
+            strcpy(snapfile, optarg);
+            break;
+
+         // arg --restore + register map file, type: string
+         // optional, example: ./bno055.regs
+         case opt_restore:
+            if(verbose == 1) printf("Debug: arg --restore, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(restfile)) {
+               printf("Error: restore filename too long.\n");
+               exit(-1);
+            }
+            strcpy(restfile, optarg);
+            break;
+
+         // arg --khz + I2C bus clock in kHz, type: int
+         // optional, for the read plan, example: 400
+         case opt_khz:
+            if(verbose == 1) printf("Debug: arg --khz, value %s\n", optarg);
+            buskhz = atoi(optarg);
+            if(buskhz < 10 || buskhz > 3400) {
+               printf("Error: invalid --khz bus clock argument.\n");
+               exit(-1);
+            }
+            break;
+
          // arg -h usage, type: flag, optional
          case 'h':
             usage(); exit(0);
             break;
 
          case '?':
-            if(isprint (optopt))
+            if(optopt == 0)
+               printf ("Error: Unknown option `%s'.\n", argv[optind - 1]);
+            else if(isprint (optopt))
                printf ("Error: Unknown option `-%c'.\n", optopt);
             else
                printf ("Error: Unknown option character `\\x%x'.\n", optopt);
@@ -240,7 +703,7 @@ void print_calstat() {
    /* -------------------------------------------------------- *
     *  Check the sensors calibration state                     *
     * -------------------------------------------------------- */
-   int res = get_calstatus(&bnoc);
+   int res = bno_get_calstatus(&bnoc);
    if(res != 0) {
       printf("Error: Cannot read calibration state.\n");
       exit(-1);
@@ -317,11 +780,13 @@ void print_calstat() {
 
 int main(int argc, char *argv[]) {
    int res = -1;       // res = function retcode: 0=OK, -1 = Error
+   bno_errprint = 1;   // library errors go to the console
 
    /* ---------------------------------------------------------- *
     * Process the cmdline parameters                             *
     * ---------------------------------------------------------- */
    parseargs(argc, argv);
+   bno_set_debug(verbose);
 
    /* ----------------------------------------------------------- *
     * get current time (now), write program start if verbose      *
@@ -329,20 +794,104 @@ int main(int argc, char *argv[]) {
    time_t tsnow = time(NULL);
    if(verbose == 1) printf("Debug: ts=[%lld] date=%s", (long long) tsnow, ctime(&tsnow));
 
+   /* ----------------------------------------------------------- *
+    * "-x" trace all bus operations from the start, write at exit *
+    * ----------------------------------------------------------- */
+   if(strlen(tracefile) > 0 && bno_trace_open(tracefile, traceev) != 0) exit(-1);
+
    /* ----------------------------------------------------------- *
     * "-a" open the I2C bus and connect to the sensor i2c address *
     * ----------------------------------------------------------- */
-   get_i2cbus(i2c_bus, senaddr);
+   if(bno_get_i2cbus(i2c_bus, senaddr) != 0) exit(-1);
+
+   /* ----------------------------------------------------------- *
+    *  "-e" run the batch commands on the open bus and exit       *
+    * ----------------------------------------------------------- */
+   if(strlen(cmdscript) > 0) exit(cmd_run(cmdscript, outfmt, buskhz > 0 ? buskhz : bno_plan_khz(i2c_bus)) == 0 ? 0 : -1);
 
    /* ----------------------------------------------------------- *
     *  "-d" dump the register map content and exit the program    *
     * ----------------------------------------------------------- */
-    if(argflag == 1) {
-      res = bno_dump();
+   if(argflag == 1) {
+      struct bnoregs regs, prev;
+      struct timespec next;
+      int dumps = 0;
+
+      /* -------------------------------------------------------- *
+       * "--watch" dumps again on a fixed grid until SIGINT, and  *
+       * marks the bytes that changed since the previous dump     *
+       * -------------------------------------------------------- */
+      if(watchrate > 0) {
+         signal(SIGINT, con_stop);
+         signal(SIGTERM, con_stop);
+      }
+      clock_gettime(CLOCK_MONOTONIC, &next);
+      while(stopflag == 0) {
+         if(bno_dump(&regs) != 0) {
+            printf("Error: could not dump the register maps.\n");
+            exit(-1);
+         }
+         if(watchrate > 0 && outfmt == fmt_txt && isatty(fileno(stdout)))
+            printf("\033[H\033[2J");
+         print_regs(&regs, dumps > 0 ? &prev : NULL, outfmt, stdout);
+         fflush(stdout);
+         prev = regs;
+         dumps++;
+         if(watchrate == 0) break;
+
+         int64_t ns = next.tv_nsec + (int64_t) (1e9 / watchrate);
+         next.tv_sec += ns / 1000000000;
+         next.tv_nsec = ns % 1000000000;
+         clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+      }
+      exit(0);
+   }
+
+   /* ----------------------------------------------------------- *
+    *  "--snapshot" save the register map setup and exit          *
+    * ----------------------------------------------------------- */
+   if(strlen(snapfile) > 0) {
+      struct bnoregs regs;
+      FILE *fp;
+      if(bno_snapshot(&regs) != 0) {
+         printf("Error: could not read the register maps.\n");
+         exit(-1);
+      }
+      if(! (fp = fopen(snapfile, "w"))) {
+         printf("Error: Can't open %s for writing.\n", snapfile);
+         exit(-1);
+      }
+      print_regs(&regs, NULL, fmt_bin, fp);
+      if(fclose(fp) != 0) {
+         printf("Error: write failure for snapshot file %s.\n", snapfile);
+         exit(-1);
+      }
+      if(verbose == 1) printf("Debug: Register map snapshot saved to %s\n", snapfile);
+      exit(0);
+   }
+
+   /* ----------------------------------------------------------- *
+    *  "--restore" write back the setup of a snapshot and exit    *
+    * ----------------------------------------------------------- */
+   if(strlen(restfile) > 0) {
+      struct bnoregs regs;
+      FILE *fp;
+      if(! (fp = fopen(restfile, "r"))) {
+         printf("Error: Can't open %s for reading.\n", restfile);
+         exit(-1);
+      }
+      res = read_regs(fp, &regs);
+      fclose(fp);
       if(res != 0) {
-         printf("Error: could not dump the register maps.\n");
+         printf("Error: %s is not a register map snapshot.\n", restfile);
          exit(-1);
       }
+      int64_t t0 = bno_trace_now();
+      if((res = bno_restore(&regs)) < 0) {
+         printf("Error: could not restore the register maps.\n");
+         exit(-1);
+      }
+      printf("Restored %d registers from %s in %.1f ms\n", res, restfile, (bno_trace_now() - t0) / 1e6);
       exit(0);
    }
 
@@ -362,26 +911,13 @@ int main(int argc, char *argv[]) {
     *  "-m" set the sensor operational mode and exit the program  *
     * ----------------------------------------------------------- */
    if(strlen(opr_mode) > 0) {
-      opmode_t newmode;
-      if(strcmp(opr_mode, "config")   == 0) newmode = config;
-      else if(strcmp(opr_mode, "acconly")  == 0) newmode = acconly;
-      else if(strcmp(opr_mode, "magonly")  == 0) newmode = magonly;
-      else if(strcmp(opr_mode, "gyronly")  == 0) newmode = gyronly;
-      else if(strcmp(opr_mode, "accmag")   == 0) newmode = accmag;
-      else if(strcmp(opr_mode, "accgyro")  == 0) newmode = accgyro;
-      else if(strcmp(opr_mode, "maggyro")  == 0) newmode = maggyro;
-      else if(strcmp(opr_mode, "amg")      == 0) newmode = amg;
-      else if(strcmp(opr_mode, "imu")      == 0) newmode = imu;
-      else if(strcmp(opr_mode, "compass")  == 0) newmode = compass;
-      else if(strcmp(opr_mode, "m4g")      == 0) newmode = m4g;
-      else if(strcmp(opr_mode, "ndof")     == 0) newmode = ndof;
-      else if(strcmp(opr_mode, "ndof_fmc") == 0) newmode = ndof_fmc;
-      else {
+      int newmode = bno_get_modecode(opr_mode);
+      if(newmode < 0) {
          printf("Error: invalid operations mode %s.\n", opr_mode);
          exit(-1);
       }
       
-      res = set_mode(newmode);
+      res = bno_set_mode(newmode);
       if(res != 0) {
          printf("Error: could not set sensor mode %s [0x%02X].\n", opr_mode, newmode);
          exit(-1);
@@ -393,21 +929,18 @@ int main(int argc, char *argv[]) {
     *  "-p" set the sensor power mode and exit the program        *
     * ----------------------------------------------------------- */
    if(strlen(pwr_mode) > 0) {
-      power_t newmode;
-      if(strcmp(pwr_mode, "normal")   == 0) newmode = normal;
-      else if(strcmp(pwr_mode, "low")  == 0) newmode = low;
-      else if(strcmp(pwr_mode, "suspend")  == 0) newmode = suspend;
-      else {
+      int newmode = bno_get_pwrcode(pwr_mode);
+      if(newmode < 0) {
          printf("Error: invalid power mode %s.\n", pwr_mode);
          exit(-1);
       }
 
-      if(newmode == get_power()) {
+      if(newmode == bno_get_power()) {
          if(verbose == 1) printf("Debug: Sensor already in mode %s [0x%02X].\n", pwr_mode, newmode);
          exit(0);
       }
 
-      res = set_power(newmode);
+      res = bno_set_power(newmode);
       if(res != 0) {
          printf("Error: could not set power mode %s [0x%02X].\n", pwr_mode, newmode);
          exit(-1);
@@ -415,11 +948,46 @@ int main(int argc, char *argv[]) {
       exit(0);
    }
 
+   /* ----------------------------------------------------------- *
+    *  "-c" set the sensor clock source and exit the program      *
+    * ----------------------------------------------------------- */
+   if(strlen(clk_src) > 0) {
+      int ext = (strcmp(clk_src, "ext") == 0);
+      if(bno_get_clksrc() == ext) {
+         if(verbose == 1) printf("Debug: Sensor already uses clock %s.\n", clk_src);
+         exit(0);
+      }
+      res = bno_set_clksrc(ext);
+      if(res != 0) {
+         printf("Error: could not set clock source %s.\n", clk_src);
+         exit(-1);
+      }
+      exit(0);
+   }
+
+   /* ----------------------------------------------------------- *
+    *  "-i" configure the motion interrupts and exit the program  *
+    * ----------------------------------------------------------- */
+   if(strlen(intspec) > 0) {
+      struct bnoint bnoi;
+      if(bno_get_int_conf(&bnoi) != 0) exit(-1);
+      if(parse_intspec(intspec, &bnoi) != 0) {
+         printf("Error: invalid interrupt configuration %s.\n", intspec);
+         exit(-1);
+      }
+      res = bno_set_int_conf(&bnoi);
+      if(res != 0) {
+         printf("Error: could not set interrupt configuration %s.\n", intspec);
+         exit(-1);
+      }
+      if(strcmp(datatype, "con") != 0) exit(0);  // -i -t con -I in one run
+   }
+
    /* ----------------------------------------------------------- *
     *  "-l" loads the sensor calibration data from file.          *
     * To update calibration data, sensor must be in CONFIG mode.  *
     * ----------------------------------------------------------- */
-    if(argflag == 3) load_cal(calfile);
+    if(argflag == 3 && bno_load_cal(calfile) != 0) exit(-1);
 
    /* ----------------------------------------------------------- *
     * -t "cal"  print the sensor calibration data                 *
@@ -429,7 +997,7 @@ int main(int argc, char *argv[]) {
       /* -------------------------------------------------------- *
        *  Read the sensors calibration state                      *
        * -------------------------------------------------------- */
-      res = get_calstatus(&bnoc);
+      res = bno_get_calstatus(&bnoc);
       if(res != 0) {
          printf("Error: Cannot read calibration state.\n");
          exit(-1);
@@ -437,7 +1005,7 @@ int main(int argc, char *argv[]) {
       /* -------------------------------------------------------- *
        *  Read the sensors calibration offset                     *
        * -------------------------------------------------------- */
-      res = get_caloffset(&bnoc);
+      res = bno_get_caloffset(&bnoc);
       if(res != 0) {
          printf("Error: Cannot read calibration data.\n");
          exit(-1);
@@ -469,7 +1037,7 @@ int main(int argc, char *argv[]) {
       /* -------------------------------------------------------- *
        *  Check the sensors calibration state                     *
        * -------------------------------------------------------- */
-      res = get_calstatus(&bnoc);
+      res = bno_get_calstatus(&bnoc);
       if(res != 0) {
          printf("Error: Cannot read calibration state.\n");
          exit(-1);
@@ -477,7 +1045,9 @@ int main(int argc, char *argv[]) {
       /* -------------------------------------------------------- *
        *  Only save data if the sensor is fully calibrated (3)    *
        * -------------------------------------------------------- */
-      if(bnoc.scal_st == 3) save_cal(calfile);
+      if(bnoc.scal_st == 3) {
+         if(bno_save_cal(calfile) != 0) exit(-1);
+      }
       else printf("Error: Sensor not fully calibrated, abort writing to file %s.\n", calfile);
    }
 
@@ -487,7 +1057,7 @@ int main(int argc, char *argv[]) {
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "inf") == 0) {
       struct bnoinf bnoi;
-      res = get_inf(&bnoi);
+      res = bno_get_inf(&bnoi);
       if(res != 0) {
          printf("Error: Cannot read sensor version data.\n");
          exit(-1);
@@ -503,12 +1073,12 @@ int main(int argc, char *argv[]) {
       printf("      Gyroscope ID = 0x%02X\n", bnoi.gyr_id);
       printf("   Magnetoscope ID = 0x%02X\n", bnoi.mag_id);
       printf("  Software Version = %d.%d\n", bnoi.sw_msb, bnoi.sw_lsb);
-      printf("   Operations Mode = "); print_mode(bnoi.opr_mode);
-      printf("        Power Mode = "); print_power(bnoi.pwr_mode);
-      printf("Axis Configuration = "); print_remap_conf(bnoi.axr_conf);
-      printf("   Axis Remap Sign = "); print_remap_sign(bnoi.axr_sign);
-      printf("System Status Code = "); print_sstat(bnoi.sys_stat);
-      printf("System Clocksource = "); print_clksrc();
+      printf("   Operations Mode = "); bno_print_mode(bnoi.opr_mode);
+      printf("        Power Mode = "); bno_print_power(bnoi.pwr_mode);
+      printf("Axis Configuration = "); bno_print_remap_conf(bnoi.axr_conf);
+      printf("   Axis Remap Sign = "); bno_print_remap_sign(bnoi.axr_sign);
+      printf("System Status Code = "); bno_print_sstat(bnoi.sys_stat);
+      printf("System Clocksource = "); bno_print_clksrc();
 
       printf("Accelerometer Test = ");
       if((bnoi.selftest >> 0) & 0x01) printf("OK\n");
@@ -563,7 +1133,7 @@ int main(int argc, char *argv[]) {
             break;
       }
 
-      print_unit(bnoi.unitsel);
+      bno_print_unit(bnoi.unitsel);
 
       printf("Sensor Temperature = ");
       if(bnoi.opr_mode > 0) {
@@ -574,19 +1144,100 @@ int main(int argc, char *argv[]) {
 
       printf("\n----------------------------------------------\n");
       struct bnoaconf bnoac;
-      if(get_acc_conf(&bnoac) == 0) print_acc_conf(&bnoac);
+      if(bno_get_acc_conf(&bnoac) == 0) bno_print_acc_conf(&bnoac);
 
       printf("\n----------------------------------------------\n");
       print_calstat();
       exit(0);
    }
 
+   /* ----------------------------------------------------------- *
+    * -t "int"  print the interrupt configuration and status      *
+    * ----------------------------------------------------------- */
+   if(strcmp(datatype, "int") == 0) {
+      struct bnoint bnoi;
+      if(bno_get_int_conf(&bnoi) != 0) {
+         printf("Error: Cannot read interrupt configuration.\n");
+         exit(-1);
+      }
+      bno_print_int_conf(&bnoi);
+      int stat = bno_get_intstat();
+      if(stat < 0) exit(-1);
+      printf("Interrupt    Status = "); bno_print_intstat(stat, stdout);
+      exit(0);
+   }
+
+   /* ----------------------------------------------------------- *
+    * -t "stats" reads all data channels for one second, paced at *
+    * the -s rate or the fusion rate, then shows the bus counters *
+    * and how many sensors of this kind would fit on the bus.     *
+    * ----------------------------------------------------------- */
+   if(strcmp(datatype, "stats") == 0) {
+      double hz = conrate > 0 ? conrate : BNO_FUSION_HZ;
+      if(sched_init(hz, 0, 0) != 0) exit(-1);
+
+      struct bnoraw bnor;
+      unsigned long samples = 0;
+      memset(&bno_busstat, 0, sizeof(bno_busstat));
+      int64_t start = bno_trace_now();
+      while(bno_trace_now() - start < 1000000000) {
+         sched_wait();
+         if(bno_get_raw(&bnor, BNO_CH_ALL) == 0) samples++;
+      }
+      bno_bus_report(stdout, (bno_trace_now() - start) / 1e9, samples, hz);
+      exit(0);
+   }
+
+   /* ----------------------------------------------------------- *
+    *  "-t acc,gyr,qua,temp" reads any list of data types, and    *
+    * "-t temp" the temperature, with the read plan of the least  *
+    * bus time. Fusion data requires a fusion mode (mode > 7).    *
+    * ----------------------------------------------------------- */
+   if(strchr(datatype, ',') != NULL || strcmp(datatype, "temp") == 0) {
+      int mask = bno_plan_mask(datatype);
+      if(mask < 0) {
+         printf("Error: Cannot get valid -t data type list %s.\n", datatype);
+         exit(-1);
+      }
+      if(mask & ~(BNO_CH_ACC | BNO_CH_MAG | BNO_CH_GYR | BNO_CH_TMP)) {
+         int mode = bno_get_mode();
+         if(mode < 8) {
+            printf("Error getting fusion data, sensor mode %d is not a fusion mode.\n", mode);
+            exit(-1);
+         }
+      }
+      int unitsel = bno_get_unit();
+      if(unitsel < 0) exit(-1);
+
+      struct bnoplan plan;
+      if(bno_plan(&plan, mask, buskhz > 0 ? buskhz : bno_plan_khz(i2c_bus)) != 0) exit(-1);
+      if(verbose == 1) print_plan(&plan, stdout);
+
+      struct bnoraw bnor;
+      if(bno_get_plan(&plan, &bnor) != 0) {
+         printf("Error: Cannot read sensor data.\n");
+         exit(-1);
+      }
+
+      /* ----------------------------------------------------------- *
+       * print the formatted output string to stdout (Example below) *
+       * ACC 0.14 -0.38 9.79                                         *
+       * GYR 0.00 0.06 -0.12                                         *
+       * TMP 24.0                                                    *
+       * ----------------------------------------------------------- */
+      struct bnosample bnos;
+      bno_raw_to_sample(&bnor, &bnos, unitsel);
+      print_sample(&bnos, outfmt, stdout);
+
+      if(outflag == 1 && write_snapshot(htmfile, &bnos) != 0) exit(-1);
+   } /* End reading the data type list */
+
    /* ----------------------------------------------------------- *
     *  "-t acc " reads accelerometer data from the sensor.        *
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "acc") == 0) {
       struct bnoacc bnod;
-      res = get_acc(&bnod);
+      res = bno_get_acc(&bnod);
       if(res != 0) {
          printf("Error: Cannot read accelerometer data.\n");
          exit(-1);
@@ -596,26 +1247,11 @@ int main(int argc, char *argv[]) {
        * print the formatted output string to stdout (Example below) *
        * ACC -45.00 264.00 939.00 (ACC X Y Z)                        *
        * ----------------------------------------------------------- */
-      printf("ACC %3.2f %3.2f %3.2f\n", bnod.adata_x, bnod.adata_y, bnod.adata_z);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing accelerometer data       *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Accelerometer X:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.adata_x);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Accelerometer Y:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.adata_y);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Accelerometer Z:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.adata_z);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      struct bnosample bnos = { .mask = BNO_CH_ACC, .acc = bnod };
+      clock_gettime(CLOCK_REALTIME, &bnos.ts);
+      print_sample(&bnos, outfmt, stdout);
+
+      if(outflag == 1 && write_snapshot(htmfile, &bnos) != 0) exit(-1);
    } /* End reading Accelerometer */
 
    /* ----------------------------------------------------------- *
@@ -623,7 +1259,7 @@ int main(int argc, char *argv[]) {
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "gyr") == 0) {
       struct bnogyr bnod;
-      res = get_gyr(&bnod);
+      res = bno_get_gyr(&bnod);
       if(res != 0) {
          printf("Error: Cannot read gyroscope data.\n");
          exit(-1);
@@ -633,26 +1269,11 @@ int main(int argc, char *argv[]) {
        * print the formatted output string to stdout (Example below) *
        * GYR 0.00 0.06 -0.12 (GYR X Y Z)                             *
        * ----------------------------------------------------------- */
-      printf("GYR %3.2f %3.2f %3.2f\n", bnod.gdata_x, bnod.gdata_y, bnod.gdata_z);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing gyroscope data           *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Gyroscope X:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.gdata_x);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Gyroscope Y:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.gdata_y);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Gyroscope Z:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.gdata_z);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      struct bnosample bnos = { .mask = BNO_CH_GYR, .gyr = bnod };
+      clock_gettime(CLOCK_REALTIME, &bnos.ts);
+      print_sample(&bnos, outfmt, stdout);
+
+      if(outflag == 1 && write_snapshot(htmfile, &bnos) != 0) exit(-1);
    } /* End reading Gyroscope */
 
    /* ----------------------------------------------------------- *
@@ -660,7 +1281,7 @@ int main(int argc, char *argv[]) {
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "mag") == 0) {
       struct bnomag bnod;
-      res = get_mag(&bnod);
+      res = bno_get_mag(&bnod);
       if(res != 0) {
          printf("Error: Cannot read magnetometer data.\n");
          exit(-1);
@@ -670,26 +1291,11 @@ int main(int argc, char *argv[]) {
        * print the formatted output string to stdout (Example below) *              
        * MAG -220.00 50.62 -345.62 (MAG X Y Z in Micro Tesla)        *
        * ----------------------------------------------------------- */
-      printf("MAG %3.2f %3.2f %3.2f\n", bnod.mdata_x, bnod.mdata_y, bnod.mdata_z);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing Magnetometer data        *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Magnetometer X:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.mdata_x);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Magnetometer Y:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.mdata_y);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Magentometer Z:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.mdata_z);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      struct bnosample bnos = { .mask = BNO_CH_MAG, .mag = bnod };
+      clock_gettime(CLOCK_REALTIME, &bnos.ts);
+      print_sample(&bnos, outfmt, stdout);
+
+      if(outflag == 1 && write_snapshot(htmfile, &bnos) != 0) exit(-1);
    } /* End reading Magnetometer data */
 
    /* ----------------------------------------------------------- *
@@ -698,14 +1304,14 @@ int main(int argc, char *argv[]) {
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "eul") == 0) {
 
-      int mode = get_mode();
+      int mode = bno_get_mode();
       if(mode < 8) {
          printf("Error getting Euler data, sensor mode %d is not a fusion mode.\n", mode);
          exit(-1);
       }
 
       struct bnoeul bnod;
-      res = get_eul(&bnod);
+      res = bno_get_eul(&bnod);
       if(res != 0) {
          printf("Error: Cannot read Euler orientation data.\n");
          exit(-1);
@@ -715,26 +1321,11 @@ int main(int argc, char *argv[]) {
        * print the formatted output string to stdout (Example below) *
        * EUL 66.06 -3.00 -15.56 (EUL H R P in Degrees)               *
        * ----------------------------------------------------------- */
-      printf("EUL %3.4f %3.4f %3.4f\n", bnod.eul_head, bnod.eul_roll, bnod.eul_pitc);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing Euler Orientation data   *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Euler Heading:<span class=\"sensorvalue\">%f</span></td>\n", bnod.eul_head);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Euler Roll:<span class=\"sensorvalue\">%f</span></td>\n", bnod.eul_roll);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Euler Pitch:<span class=\"sensorvalue\">%f</span></td>\n", bnod.eul_pitc);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      struct bnosample bnos = { .mask = BNO_CH_EUL, .eul = bnod };
+      clock_gettime(CLOCK_REALTIME, &bnos.ts);
+      print_sample(&bnos, outfmt, stdout);
+
+      if(outflag == 1 && write_snapshot(htmfile, &bnos) != 0) exit(-1);
    } /* End reading Euler Orientation */
 
   /* ----------------------------------------------------------- *
@@ -743,53 +1334,226 @@ int main(int argc, char *argv[]) {
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "con") == 0) {
 
-      int mode = get_mode();
+      int mode = bno_get_mode();
       if(mode < 8) {
          printf("Error getting Euler data, sensor mode %d is not a fusion mode.\n", mode);
          exit(-1);
       }
 
-      struct bnoeul bnod;
+      /* ----------------------------------------------------------- *
+       * "-s Hz:idleHz:low" sets the low power mode once, before the *
+       * loop. The sensor then sleeps after its no-motion time and   *
+       * wakes up on any-motion by itself, without a CONFIG switch.  *
+       * ----------------------------------------------------------- */
+      int oldpwr = bno_get_power();
+      if(idlepwr == 1 && oldpwr != BNO_PWR_LOW && bno_set_power(BNO_PWR_LOW) != 0) {
+         printf("Error: could not set power mode low.\n");
+         exit(-1);
+      }
+
+      /* ----------------------------------------------------------- *
+       * Save the sensor setup, to restore it after a failure where  *
+       * the sensor was reset, e.g. by a brown-out                   *
+       * ----------------------------------------------------------- */
+      if(rcv_init(mode) != 0) {
+         printf("Error: Cannot read the sensor setup.\n");
+         exit(-1);
+      }
+
+      /* ----------------------------------------------------------- *
+       * "-H" start the HTTP server thread for live data viewers     *
+       * ----------------------------------------------------------- */
+      if(strlen(webbind) > 0 && web_start(webbind) != 0) exit(-1);
+
+      /* ----------------------------------------------------------- *
+       * "-L" log all data channels, they are read in a single burst *
+       * ----------------------------------------------------------- */
+      int conmask = BNO_CH_EUL;
+      int unitsel = 0;
+      if(strlen(logfile) > 0 || strlen(recfile) > 0) {
+         conmask = BNO_CH_ALL;
+         unitsel = bno_get_unit();
+      }
+
+      /* ----------------------------------------------------------- *
+       * "-s" pacing, the idle rate needs the gyr and lin channels   *
+       * ----------------------------------------------------------- */
+      if(sched_init(conrate, idlerate, keepdup == 0) != 0) exit(-1);
+      if(idlerate > 0) {
+         conmask |= BNO_CH_GYR | BNO_CH_LIN;
+         unitsel = bno_get_unit();
+      }
+      if(strlen(logfile) > 0 && log_open(logfile, conmask, unitsel) != 0) exit(-1);
+
+      /* ----------------------------------------------------------- *
+       * The read plans are computed once: plan[1] also reads the    *
+       * status registers for the health check every BNO_RCV_HEALTH  *
+       * ----------------------------------------------------------- */
+      struct bnoplan plan[2];
+      int khz = buskhz > 0 ? buskhz : bno_plan_khz(i2c_bus);
+      if(bno_plan(&plan[0], conmask, khz) != 0
+         || bno_plan(&plan[1], conmask | BNO_RAW_STATUS, khz) != 0) exit(-1);
+      if(verbose == 1) { print_plan(&plan[0], stdout); print_plan(&plan[1], stdout); }
+
+      /* ----------------------------------------------------------- *
+       * "-f" flight recorder ring, it needs the acc channel as well *
+       * ----------------------------------------------------------- */
+      if(strlen(recfile) > 0
+         && rec_open(recfile, recpre, recpost, recthres, unitsel, outfmt) != 0) exit(-1);
+      /* ----------------------------------------------------------- *
+       * "-I" sleep until the INT pin fires, instead of polling. With*
+       * "-I sim", the simulated sensor signals its INT pin eventfd  *
+       * ----------------------------------------------------------- */
+      if(strcmp(irqline, "sim") == 0) {
+         if(strcmp(i2c_bus, "sim") != 0 || bno_sim_irqfd() < 0) {
+            printf("Error: -I sim needs the simulated sensor -b sim.\n");
+            exit(-1);
+         }
+         irq_attach(bno_sim_irqfd());
+      }
+      else if(strlen(irqline) > 0 && irq_open(irqline) != 0) exit(-1);
+
+      /* ----------------------------------------------------------- *
+       * "-T" real-time loop, after the helper threads are started,  *
+       * so that they keep the normal scheduling policy. Free reads  *
+       * without any sleep (-D without -s) would starve the system.  *
+       * ----------------------------------------------------------- */
+      if(rtprio > 0) {
+         if(keepdup == 1 && conrate == 0) {
+            printf("Error: -T needs paced reads, use -s with -D.\n");
+            exit(-1);
+         }
+         if(sched_rt(rtprio, rtcpu) != 0) exit(-1);
+      }
+
+      signal(SIGINT, con_stop);
+      signal(SIGTERM, con_stop);
+      signal(SIGUSR1, con_hist);
+
+      struct bnoraw bnor, prev;
+      memset(&bnor, 0, sizeof(bnor));
+      memset(&prev, 0, sizeof(prev));
+      int64_t prevupd = 0;
+      unsigned long delivered = 0, lost = 0, reads = 0;
+      double expect = 1e9 / (conrate > 0 && conrate < BNO_FUSION_HZ ? conrate : BNO_FUSION_HZ);
       /* ----------------------------------------------------------- *
        * print the formatted output string to stdout (Example below) *
        * EUL 66.06 -3.00 -15.56 (EUL H R P in Degrees)               *
        * ----------------------------------------------------------- */
-      while(1){
-        clock_t t;
-        t = clock();
+      while(stopflag == 0){
+        if(histflag == 1) {
+           histflag = 0;
+           hist_print(stderr);
+        }
+        /* --------------------------------------------------------- *
+         * "-I" waits for an edge at most BNO_IRQ_TIMEOUT_MS, after  *
+         * that a status-only read runs the health check, so that a  *
+         * sensor which lost its setup is found without an edge      *
+         * --------------------------------------------------------- */
+        int wake = 1;
+        if(strlen(irqline) > 0) {
+           wake = irq_wait(BNO_IRQ_TIMEOUT_MS);
+           if(wake < 0) continue;
+           if(wake == 1) {
+              int stat = bno_get_intstat();
+              bno_int_reset();
+              if(outfmt == fmt_txt) { printf("INT "); bno_print_intstat(stat, stdout); }
+           }
+        }
+        if(wake == 1) sched_wait();
 
-        res = get_eul(&bnod);
+        int status = wake == 0 || (reads++ % BNO_RCV_HEALTH) == 0 ? BNO_RAW_STATUS : 0;
+        res = bno_get_plan(&plan[status != 0], &bnor);
         if(res != 0) {
            printf("Error: Cannot read Euler orientation data.\n");
+           rcv_recover();
            continue;
         }
-
-        printf("EUL %3.4f %3.4f %3.4f\n", bnod.eul_head, bnod.eul_roll, bnod.eul_pitc);
-
-        if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing Euler Orientation data   *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Euler Heading:<span class=\"sensorvalue\">%f</span></td>\n", bnod.eul_head);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Euler Roll:<span class=\"sensorvalue\">%f</span></td>\n", bnod.eul_roll);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Euler Pitch:<span class=\"sensorvalue\">%f</span></td>\n", bnod.eul_pitc);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
+        hist_add(BNO_HIST_BUS, bnor.t1 - bnor.t0);
+
+        /* --------------------------------------------------------- *
+         * Every BNO_RCV_HEALTH reads, the status registers come with*
+         * the burst: a sensor that lost its mode or reports a system*
+         * error is restored, and this sample is dropped             *
+         * --------------------------------------------------------- */
+        if(status != 0 && rcv_health(&bnor) != 0) continue;
+        if(wake == 0) continue;
+        if(val_mode != 0 && val_sample(&bnor) != 0) continue;
+
+        /* --------------------------------------------------------- *
+         * Unchanged data within one sensor update period of the last*
+         * sample means the sensor has not updated its output yet,   *
+         * drop the read before any decoding and output work. Later, *
+         * unchanged data is a real sample of a sensor at rest, e.g. *
+         * the scheduled sample at the idle rate.                    *
+         * --------------------------------------------------------- */
+        int fresh = memcmp(bnor.val, prev.val, sizeof(bnor.val)) != 0;
+        int dup = fresh == 0 && bnor.t0 - prev.t0 < 1000000000 / BNO_FUSION_HZ;
+        sched_sync(fresh);
+        int64_t upd = drift_update(&bnor, fresh);
+        if(dup == 0) {
+           /* ----------------------------------------------------- *
+            * A gap of n expected sample periods lost n-1 samples,  *
+            * not counted with an idle rate or -I, that skip on     *
+            * purpose                                               *
+            * ----------------------------------------------------- */
+           if(prevupd > 0) {
+              hist_add(BNO_HIST_INTERVAL, upd - prevupd);
+              long gap = llround((upd - prevupd) / expect) - 1;
+              if(gap > 0 && idlerate == 0 && strlen(irqline) == 0) lost += gap;
+           }
+           prevupd = upd;
+           delivered++;
+        }
+        if(dup == 1 && keepdup == 0) continue;
+        prev = bnor;
+        log_write(&bnor);
+        rec_write(&bnor);
+
+        struct bnosample bnos;
+        bno_raw_to_sample(&bnor, &bnos, unitsel);
+        sched_update(&bnos, unitsel);
+        bnos.mask = BNO_CH_EUL;
+        print_sample(&bnos, outfmt, stdout);
+        fflush(stdout);
+
+        if(outflag == 1) write_snapshot(htmfile, &bnos);
+        if(strlen(webbind) > 0) web_publish(&bnos);
+        if(strlen(metricfile) > 0) bno_bus_metrics_file(metricfile);
+
+        /* --------------------------------------------------------- *
+         * End to end latency: from the sensor update instant (or    *
+         * the end of the read without clock model) to output done   *
+         * --------------------------------------------------------- */
+        if(fresh == 1) {
+           struct timespec now;
+           clock_gettime(CLOCK_MONOTONIC, &now);
+           hist_add(BNO_HIST_LATENCY, (int64_t) now.tv_sec * 1000000000 + now.tv_nsec - upd);
         }
+      }
 
-        t = clock() - t;
-        double time_taken = ((double)t)/CLOCKS_PER_SEC; // in seconds
-        printf("Sensor reading took %f seconds \n", time_taken);
+      /* ----------------------------------------------------------- *
+       * Stopped by SIGINT/SIGTERM, finish the log file with index   *
+       * ----------------------------------------------------------- */
+      rec_close();
+      irq_close();
+      if(idlepwr == 1 && oldpwr >= 0 && oldpwr != BNO_PWR_LOW && bno_set_power(oldpwr) != 0)
+         printf("Error: could not restore power mode %d.\n", oldpwr);
+      sched_report(stderr);
+      print_plan(&plan[0], stderr);
+      drift_report(stderr);
+      rcv_report(stderr);
+      val_report(stderr);
+      rec_report(stderr);
+      bno_fault_report(stderr);
+      if(lost > 0 || bno_fault_on == 1)
+         fprintf(stderr, "Lost samples: %lu of %lu (%.2f%%)\n", lost, delivered + lost,
+                 100.0 * lost / (delivered + lost > 0 ? delivered + lost : 1));
+      hist_print(stderr);
+      if(log_close() != 0) {
+         printf("Error: could not finish log file %s.\n", logfile);
+         exit(-1);
       }
-      
    } /* End reading continuous data */
 
    /* ----------------------------------------------------------- *
@@ -798,14 +1562,14 @@ int main(int argc, char *argv[]) {
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "qua") == 0) {
 
-      int mode = get_mode();
+      int mode = bno_get_mode();
       if(mode < 8) {
          printf("Error getting Quaternation, sensor mode %d is not a fusion mode.\n", mode);
          exit(-1);
       }
 
       struct bnoqua bnod;
-      res = get_qua(&bnod);
+      res = bno_get_qua(&bnod);
       if(res != 0) {
          printf("Error: Cannot read Quaternation data.\n");
          exit(-1);
@@ -815,28 +1579,11 @@ int main(int argc, char *argv[]) {
        * print the formatted output string to stdout (Example below) *
        * QUA 0.83 0.13 -0.05 -0.54 (QUA W X Y Z)                     *
        * ----------------------------------------------------------- */
-      printf("QUA %3.2f %3.2f %3.2f %3.2f\n", bnod.quater_w, bnod.quater_x, bnod.quater_y, bnod.quater_z);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing Quaternation data        *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Quaternation W:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.quater_w);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Quaternation X:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.quater_x);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Quaternation Y:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.quater_y);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Quaternation Z:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.quater_z);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      struct bnosample bnos = { .mask = BNO_CH_QUA, .qua = bnod };
+      clock_gettime(CLOCK_REALTIME, &bnos.ts);
+      print_sample(&bnos, outfmt, stdout);
+
+      if(outflag == 1 && write_snapshot(htmfile, &bnos) != 0) exit(-1);
    } /* End reading Quaternation data */
 
    /* ----------------------------------------------------------- *
@@ -845,14 +1592,14 @@ int main(int argc, char *argv[]) {
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "gra") == 0) {
 
-      int mode = get_mode();
+      int mode = bno_get_mode();
       if(mode < 8) {
          printf("Error getting Gravity Vector, sensor mode %d is not a fusion mode.\n", mode);
          exit(-1);
       }
 
       struct bnogra bnod;
-      res = get_gra(&bnod);
+      res = bno_get_gra(&bnod);
       if(res != 0) {
          printf("Error: Cannot read gravity vector data.\n");
          exit(-1);
@@ -862,26 +1609,11 @@ int main(int argc, char *argv[]) {
        * print the formatted output string to stdout (Example below) *
        * GRA -3.19 16.38 58.94 (GRA X Y Z)                           *
        * ----------------------------------------------------------- */
-      printf("GRA %3.2f %3.2f %3.2f\n", bnod.gravityx, bnod.gravityy, bnod.gravityz);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing gravity vector data      *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Gravity Vector X:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.gravityx);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Gravity Vector Y:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.gravityy);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Gravity Vector Z:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.gravityz);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      struct bnosample bnos = { .mask = BNO_CH_GRA, .gra = bnod };
+      clock_gettime(CLOCK_REALTIME, &bnos.ts);
+      print_sample(&bnos, outfmt, stdout);
+
+      if(outflag == 1 && write_snapshot(htmfile, &bnos) != 0) exit(-1);
    } /* End reading Gravity  Vector */
 
    /* ----------------------------------------------------------- *
@@ -890,14 +1622,14 @@ int main(int argc, char *argv[]) {
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "lin") == 0) {
 
-      int mode = get_mode();
+      int mode = bno_get_mode();
       if(mode < 8) {
          printf("Error getting Linear Acceleration, sensor mode %d is not a fusion mode.\n", mode);
          exit(-1);
       }
 
       struct bnolin bnod;
-      res = get_lin(&bnod);
+      res = bno_get_lin(&bnod);
       if(res != 0) {
          printf("Error: Cannot read linear acceleration data.\n");
          exit(-1);
@@ -907,26 +1639,11 @@ int main(int argc, char *argv[]) {
        * print the formatted output string to stdout (Example below) *
        * LIN 0.44 0.19 -0.38 (LIN X Y Z)                             *
        * ----------------------------------------------------------- */
-      printf("LIN %3.2f %3.2f %3.2f\n", bnod.linacc_x, bnod.linacc_y, bnod.linacc_z);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing linear acceleration data *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Linear Acceleration X:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.linacc_x);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Linear Acceleration Y:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.linacc_y);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Linear Acceleration Z:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.linacc_z);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      struct bnosample bnos = { .mask = BNO_CH_LIN, .lin = bnod };
+      clock_gettime(CLOCK_REALTIME, &bnos.ts);
+      print_sample(&bnos, outfmt, stdout);
+
+      if(outflag == 1 && write_snapshot(htmfile, &bnos) != 0) exit(-1);
    } /* End reading Linear Acceleration */
 
    exit(0);
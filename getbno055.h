@@ -1,9 +1,14 @@
 /* ------------------------------------------------------------ *
  * file:        getbno055.h                                     *
  * purpose:     header file for getbno055.c and i2c_bno055.c    *
+ *              the library API is in bno055.h                  *
  *                                                              *
  * author:      05/04/2018 Frank4DD                             *
  * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "bno055.h"
 
 #define I2CBUS               "/dev/i2c-1"
 #define BNO055_ID            0xA0
@@ -164,188 +169,298 @@
 #define BNO055_GYR_CONFIG1_ADDR           0x0B
 #define BNO055_ACC_SLEEP_CONFIG_ADDR      0x0C
 #define BNO055_GYR_SLEEP_CONFIG_ADDR      0x0D
+#define BNO055_INT_MSK_ADDR               0x0F
+#define BNO055_INT_EN_ADDR                0x10
+#define BNO055_ACC_AM_THRES_ADDR          0x11
+#define BNO055_ACC_INT_SET_ADDR           0x12
+#define BNO055_ACC_HG_DURATION_ADDR       0x13
+#define BNO055_ACC_HG_THRES_ADDR          0x14
+#define BNO055_ACC_NM_THRES_ADDR          0x15
+#define BNO055_ACC_NM_SET_ADDR            0x16
+#define BNO055_GYR_INT_SET_ADDR           0x17
+#define BNO055_GYR_HR_X_SET_ADDR          0x18
+#define BNO055_GYR_DUR_X_ADDR             0x19
+#define BNO055_GYR_HR_Y_SET_ADDR          0x1A
+#define BNO055_GYR_DUR_Y_ADDR             0x1B
+#define BNO055_GYR_HR_Z_SET_ADDR          0x1C
+#define BNO055_GYR_DUR_Z_ADDR             0x1D
+#define BNO055_GYR_AM_THRES_ADDR          0x1E
+#define BNO055_GYR_AM_SET_ADDR            0x1F
+#define BNO055_INT_REGCOUNT               17   // 0x0F..0x1F burst
 
 /* ------------------------------------------------------------ *
  * global variables                                             *
  * ------------------------------------------------------------ */
 extern int verbose;     // debug flag, 0 = normal, 1 = debug mode
+extern int bno_debug;   // library debug flag, see bno_set_debug()
+extern int bno_errprint; // 1 = library errors are printed
+extern double htmrate;  // max -o file updates per second, 0 = all
 
 /* ------------------------------------------------------------ *
- * BNO055 versions, status data and other infos struct          *
+ * Output formats selected with -F, and the binary frame header *
  * ------------------------------------------------------------ */
-struct bnoinf{
-   char chip_id;  // reg 0x00 default 0xA0
-   char acc_id;   // reg 0x01 default 0xFB
-   char mag_id;   // reg 0x02 default 0x32
-   char gyr_id;   // reg 0x03 default 0x0F
-   char sw_lsb;   // reg 0x04 default 0x08
-   char sw_msb;   // reg 0x05 default 0x03
-   char bl_rev;   // reg 0x06 no default
-   char opr_mode; // reg 0x3D default 0x1C
-   char pwr_mode; // reg 0x3E default 0x00
-   char axr_conf; // reg 0x41 default 0x24
-   char axr_sign; // reg 0x42 default 0x00
-   char sys_stat; // reg 0x39 system error status, range 0-6
-   char selftest; // reg 0x36 self test result
-   char sys_err;  // reg 0x3a system error code, 0=OK
-   char unitsel;  // reg 0x3b SI units definition
-   char temp_val; // reg 0x34 sensor temperature value
-};
+typedef enum {
+   fmt_txt   = 0x00,   // "ACC x y z" text lines (default)
+   fmt_csv   = 0x01,   // comma separated values, header line
+   fmt_jsonl = 0x02,   // one JSON object per line
+   fmt_bin   = 0x03    // length-prefixed binary frames
+} outfmt_t;
+
+#define BNO_JSONSIZE         1024    // max length of one JSON Lines sample
+#define BNO_FRAME_SYNC0      0xB0
+#define BNO_FRAME_SYNC1      0x55
+#define BNO_FRAME_VERSION    0x01
+#define BNO_FRAME_HDRLEN     16
+#define BNO_FRAME_REGMAP     0x8000  // mask of a register map frame
+#define BNO_SNAP_GAP         2        // unchanged regs merged into a write
 
 /* ------------------------------------------------------------ *
- * BNO055 calibration data struct. The offset ranges depend on  *
- * the component operation range. For example, the accelerometer*
- * range can be set as 2G, 4G, 8G, and 16G. I.e. the offset for *
- * the accelerometer at 16G has a range of +/- 16000mG. Offset  *
- * is stored on the sensor in two bytes with max value of 32768.*
+ * Bus transport backend. write() and read() transfer len bytes *
+ * and return the byte count like the system calls, or -1.      *
  * ------------------------------------------------------------ */
-struct bnocal{
-   char scal_st;  // reg 0x35 system calibration state, range 0-3
-   char gcal_st;  // gyroscope calibration state, range 0-3
-   char acal_st;  // accelerometer calibration state, range 0-3
-   char mcal_st;  // magnetometer calibration state, range 0-3
-   int  aoff_x;   // accelerometer offset, X-axis
-   int  aoff_y;   // accelerometer offset, Y-axis
-   int  aoff_z;   // accelerometer offset, Z-axis
-   int  moff_x;   // magnetometer offset, X-axis
-   int  moff_y;   // magnetometer offset, Y-axis
-   int  moff_z;   // magnetometer offset, Z-axis
-   int  goff_x;   // gyroscope offset, X-axis
-   int  goff_y;   // gyroscope offset, Y-axis
-   int  goff_z;   // gyroscope offset, Z-axis
-   int acc_rad;   // accelerometer radius
-   int mag_rad;   // magnetometer radius
+struct bnobus{
+   const char *name;                      // -b selection name
+   int (*open)(const char*, int);         // device, sensor address
+   int (*write)(const void*, int);        // register address + data
+   int (*read)(void*, int);               // from the register address
+   void (*close)();
 };
 
+#define BNO_BUS_RETRIES      3        // repeats of a failed transfer
+#define BNO_BUS_BACKOFF_US   500      // first retry delay, doubles
+
+extern const struct bnobus bno_simbus;    // simulated sensor "-b sim"
+extern int bno_sim_irqfd();               // INT pin eventfd, "-I sim"
+extern int bno_fault_on;                  // 1 = fault injection, "-j"
+extern int bno_fault_init(char*);         // parse the fault spec
+extern const struct bnobus *bno_fault_wrap(const struct bnobus*); // wrap
+extern void bno_fault_report(FILE*);      // injected faults, retries
+extern struct bnostats bno_busstat;       // counters, see bno_get_stats()
+extern int bno_bus_open(const char*, int); // select backend and open
+extern int bno_bus_write(const void*, int); // write register address, data
+extern int bno_bus_read(void*, int);      // read from register address
+extern void bno_bus_sleep(int, const char*); // usec sensor wait, caller
+extern void bno_bus_close();              // release the bus device
+extern int bno_bus_reopen();              // close and open the device
+extern void bno_bus_metrics(FILE*);       // counters, Prometheus format
+extern int bno_bus_metrics_file(char*);   // replace metrics file, 1/sec
+extern void bno_bus_report(FILE*, double, unsigned long, double); // stats
+
 /* ------------------------------------------------------------ *
- * BNO055 measurement data structs. Data gets filled in based   *
- * on the sensor component type that was requested for reading. *
+ * Bus trace, "-x file[:events]" records the transport events   *
+ * in a ring and writes Chrome trace JSON at exit.              *
  * ------------------------------------------------------------ */
-struct bnoacc{
-   double adata_x;   // accelerometer data, X-axis
-   double adata_y;   // accelerometer data, Y-axis
-   double adata_z;   // accelerometer data, Z-axis
-};
-struct bnomag{
-   double mdata_x;   // magnetometer data, X-axis
-   double mdata_y;   // magnetometer data, Y-axis
-   double mdata_z;   // magnetometer data, Z-axis
-};
-struct bnogyr{
-   double gdata_x;   // gyroscope data, X-axis
-   double gdata_y;   // gyroscope data, Y-axis
-   double gdata_z;   // gyroscope data, Z-axis
-};
-struct bnoeul{
-   double eul_head;  // Euler heading data
-   double eul_roll;  // Euler roll data
-   double eul_pitc;  // Euler picth data
-};
-struct bnoqua{
-   double quater_w;  // Quaternation data W
-   double quater_x;  // Quaternation data X
-   double quater_y;  // Quaternation data Y
-   double quater_z;  // Quaternation data Z
-};
-struct bnogra{
-   double gravityx;  // Gravity Vector X
-   double gravityy;  // Gravity Vector Y
-   double gravityz;  // Gravity Vector Z
-};
-struct bnolin{
-   double linacc_x;  // Linear Acceleration X
-   double linacc_y;  // Linear Acceleration Y
-   double linacc_z;  // Linear Acceleration Z
-};
+#define BNO_TR_ADDR          0        // write of the register address
+#define BNO_TR_READ          1        // read of register data
+#define BNO_TR_WRITE         2        // write of register data
+#define BNO_TR_SLEEP         3        // wait for the sensor
+#define BNO_TR_EVENTS        65536    // default ring size
+
+extern int bno_trace_on;                  // 1 = recording bus events
+extern int bno_trace_open(char*, int);    // start tracing to file
+extern void bno_trace_add(int, int, int, int, int, int64_t, int64_t, const char*);
+extern int64_t bno_trace_now();           // CLOCK_MONOTONIC nsec
+extern void bno_trace_close();            // write the JSON trace file
 
 /* ------------------------------------------------------------ *
- * BNO055 accelerometer gyroscope magnetometer config structs   *
+ * external function prototypes for I2C bus communication code  *
  * ------------------------------------------------------------ */
-struct bnoaconf{
-   int pwrmode;      // p-1 reg 0x08 accelerometer power mode
-   int bandwth;      // p-1 reg 0x08 accelerometer bandwidth
-   int range;        // p-1 reg 0x08 accelerometer rate
-   int slpmode;      // p-1 reg 0x0C accelerometer sleep mode
-   int slpdur;       // p-1 reg 0x0C accelerometer sleep duration
-};
-struct bnomconf{
-   int pwrmode;      // p-1 reg 0x09 magnetometer power mode
-   int oprmode;      // p-1 reg 0x09 magnetometer operation
-   int outrate;      // p-1 reg 0x09 magnetometer output rate
-};
-struct bnogconf{
-   int pwrmode;      // p-1 reg 0x0B gyroscope power mode
-   int bandwth;      // p-1 reg 0x0A gyroscope bandwidth
-   int range;        // p-1 reg 0x0A gyroscope range
-   int slpdur;       // p-1 reg 0x0D gyroscope sleep duration
-   int aslpdur;      // p-1 reg 0x0D gyroscope auto sleep dur
-};
+extern void bno_error(const char*, ...);  // record, print library error
+extern int bno_get_i2cbus(char*, char*);  // get the I2C bus file handle
+extern int bno_set_page0();               // set register map page 0
+extern int bno_set_page1();               // set register map page 1
+extern void bno_print_clksrc();           // print clock source setting
+extern int bno_print_mode(int);           // print ops mode string
+extern void bno_print_unit(int);          // print SI unit configuration
+extern int bno_print_power(int);          // print power mode string
+extern int bno_print_sstat(int);          // print system status string
+extern int bno_print_remap_conf(int);     // print axis configuration
+extern int bno_print_remap_sign(int);     // print the axis remap +/-
+extern int bno_get_mag_conf(struct bnomconf*);// get magnetometer config
+extern int bno_get_gyr_conf(struct bnogconf*);// get gyroscope config
+extern int bno_set_acc_conf();                // set accelerometer config
+extern int bno_set_mag_conf();                // set magnetometer config
+extern int bno_set_gyr_conf();                // set gyroscope config
+extern void bno_print_acc_conf();         // print accelerometer config
+extern void bno_print_mag_conf();         // print magnetometer config
+extern void bno_print_gyr_conf();         // print gyroscope config
+extern void bno_print_int_conf(struct bnoint*); // print interrupt config
+extern void bno_print_intstat(int, FILE*); // print interrupt sources
 
 /* ------------------------------------------------------------ *
- * Operations and power mode, name to value translation         *
+ * external function prototypes for the data output formatting  *
  * ------------------------------------------------------------ */
-typedef enum {
-   config   = 0x00,
-   acconly  = 0x01,
-   magonly  = 0x02,
-   gyronly  = 0x03,
-   accmag   = 0x04,
-   accgyro  = 0x05,
-   maggyro  = 0x06,
-   amg      = 0x07,
-   imu      = 0x08,
-   compass  = 0x09,
-   m4g      = 0x0A,
-   ndof     = 0x0B,
-   ndof_fmc = 0x0C
-} opmode_t;
+extern int get_outfmt(char*);             // -F name to outfmt_t code
+extern void print_sample(struct bnosample*, int, FILE*); // output data
+extern int format_json(struct bnosample*, char*, int); // JSON into a buffer
+extern void print_html(struct bnosample*, FILE*); // HTML table output
+extern int write_snapshot(char*, struct bnosample*); // -o file update
+extern void print_regs(struct bnoregs*, struct bnoregs*, int, FILE*); // dump
+extern int read_regs(FILE*, struct bnoregs*); // read a register map frame
+extern void print_plan(struct bnoplan*, FILE*); // bursts and bus time
 
-typedef enum {
-   normal  = 0x00,
-   low     = 0x01,
-   suspend = 0x02
-} power_t;
+/* ------------------------------------------------------------ *
+ * external function prototypes for the embedded HTTP server    *
+ * ------------------------------------------------------------ */
+extern int web_start(char*);              // listen on [addr:]port
+extern void web_publish(struct bnosample*); // hand sample to viewers
 
 /* ------------------------------------------------------------ *
- * external function prototypes for I2C bus communication code  *
+ * Sample rate scheduler for -t con. With an idle rate, motion  *
+ * below both thresholds for HOLDMS steps down to the idle rate *
+ * and the first sample with motion steps back to the full rate *
+ * ------------------------------------------------------------ */
+#define BNO_IDLE_GYR_DPS     2.0      // gyro magnitude motion threshold
+#define BNO_IDLE_LIN_MS2     0.2      // linear acc magnitude threshold
+#define BNO_IDLE_HOLDMS      2000     // time without motion until idle
+#define BNO_FUSION_HZ        100      // fusion data output rate
+
+extern int sched_init(double, double, int); // rate, idle rate, sync
+extern void sched_wait();                 // sleep until the next sample
+extern void sched_sync(int);              // read had new data, or not
+extern void sched_update(struct bnosample*, int); // adapt to motion
+extern void sched_report(FILE*);          // transactions and CPU saved
+extern int sched_rt(int, int);            // SCHED_FIFO prio, pin to cpu
+
+/* ------------------------------------------------------------ *
+ * Sensor clock model: update k of the fusion output happens at *
+ * host CLOCK_MONOTONIC time base + phase + k * period. It is a *
+ * weighted least squares fit over the bounds of each observed  *
+ * data change, with exponential forgetting of old observations *
+ * ------------------------------------------------------------ */
+#define BNO_DRIFT_MINOBS     16       // observations before correcting
+#define BNO_DRIFT_FORGET     0.998    // weight decay per observation
+
+extern int64_t drift_update(struct bnoraw*, int); // fit, correct r->ts
+extern void drift_report(FILE*);          // sensor clock rate and phase
+
+/* ------------------------------------------------------------ *
+ * Sensor recovery after failed reads in the continuous mode    *
  * ------------------------------------------------------------ */
-extern void get_i2cbus(char*, char*);     // get the I2C bus file handle
-extern int set_page0();                   // set register map page 0
-extern int set_page1();                   // set register map page 1
-extern int get_calstatus(struct bnocal*); // read calibration status
-extern int get_caloffset(struct bnocal*); // read calibration values
-extern int get_inf(struct bnoinf*);       // read sensor information
-extern int get_acc(struct bnoacc*);       // read accelerometer data
-extern int get_mag(struct bnomag*);       // read magnetometer data
-extern int get_gyr(struct bnogyr*);       // read gyroscope data
-extern int get_eul(struct bnoeul*);       // read euler orientation
-extern int get_qua(struct bnoqua*);       // read quaternation data
-extern int get_gra(struct bnogra*);       // read gravity data
-extern int get_lin(struct bnolin*);       // read linar acceleration data
-extern int get_clksrc();                  // get the clock source setting
-extern void print_clksrc();               // print clock source setting
-extern int set_mode(opmode_t);            // set the sensor ops mode
-extern int get_mode();                    // get the sensor ops mode
-extern int print_mode(int);               // print ops mode string
-extern void print_unit(int);              // print SI unit configuration
-extern int set_power(power_t);            // set the sensor power mode
-extern int get_power();                   // get the sensor power mode
-extern int print_power(int);              // print power mode string
-extern int get_sstat();                   // get system status code
-extern int print_sstat(int);              // print system status string
-extern int get_remap(char);               // get the axis remap values
-extern int print_remap_conf(int);         // print axis configuration
-extern int print_remap_sign(int);         // print the axis remap +/-
-extern int bno_dump();                    // dump the register map data
-extern int bno_reset();                   // reset the sensor
-extern int save_cal(char*);               // write calibration to file
-extern int load_cal(char*);               // load calibration from file
-extern int get_acc_conf(struct bnoaconf*);// get accelerometer config
-extern int get_mag_conf(struct bnomconf*);// get magnetometer config
-extern int get_gyr_conf(struct bnogconf*);// get gyroscope config
-extern int set_acc_conf();                // set accelerometer config
-extern int set_mag_conf();                // set magnetometer config
-extern int set_gyr_conf();                // set gyroscope config
-extern void print_acc_conf();             // print accelerometer config
-extern void print_mag_conf();             // print magnetometer config
-extern void print_gyr_conf();             // print gyroscope config
+#define BNO_RCV_TRIES        8        // reopen and detect attempts
+#define BNO_RCV_BACKOFF_US   10000    // first reopen delay, doubles
+#define BNO_RCV_HEALTH       10       // reads per status check in -t con
+#define BNO_IRQ_TIMEOUT_MS   1000     // -I wait before a health check
+
+extern int rcv_init(int);                 // save mode and register setup
+extern int rcv_recover();                 // reopen, detect, restore setup
+extern int rcv_health(struct bnoraw*);    // check status, recover if bad
+extern void rcv_report(FILE*);            // recoveries, time to recover
+
+/* ------------------------------------------------------------ *
+ * Sanity checks of the raw sample data in the continuous mode  *
+ * ------------------------------------------------------------ */
+#define BNO_VAL_DROP         1        // -k drop, invalid samples dropped
+#define BNO_VAL_REREAD       2        // -k reread, one more read first
+#define BNO_VAL_JUMP_DEG     45       // max Euler change between reads
+#define BNO_VAL_JUMP_MS      50       // reads closer than this in time
+#define BNO_VAL_JUMPS        3        // jumps in a row accepted as real
+
+extern int val_mode;                      // -k BNO_VAL_xxx, 0 = off
+extern int val_init(char*);               // set the -k mode
+extern int val_sample(struct bnoraw*);    // 0 = valid, -1 = drop
+extern void val_report(FILE*);            // rejection counters
+
+/* ------------------------------------------------------------ *
+ * Batch commands, -e "mode config; load cal.cfg; mode ndof"    *
+ * ------------------------------------------------------------ */
+extern int cmd_run(char*, int, int);      // commands or "-" stdin, fmt, kHz
+
+/* ------------------------------------------------------------ *
+ * Timing histograms of the continuous mode loop, values in ns  *
+ * ------------------------------------------------------------ */
+#define BNO_HIST_BUS         0        // I2C transaction time
+#define BNO_HIST_LATENCY     1        // sensor update to output done
+#define BNO_HIST_INTERVAL    2        // time between new samples
+#define BNO_HIST_COUNT       3
+
+extern void hist_add(int, int64_t);       // record a value in nsec
+extern void hist_print(FILE*);            // count, mean, percentiles
+
+/* ------------------------------------------------------------ *
+ * external function prototypes for the interrupt line events   *
+ * ------------------------------------------------------------ */
+extern int irq_open(char*);               // request gpiochip:line edges
+extern void irq_attach(int);              // use an eventfd instead
+extern int irq_wait(int);                 // 1 = event, 0 = timeout
+extern void irq_close();                  // release the line
+
+/* ------------------------------------------------------------ *
+ * Compressed raw data log: file header, block header, index.   *
+ * Records store per-channel deltas as zigzag varints, the 1st  *
+ * record of each block is a keyframe with the absolute values. *
+ * A block ends after BLOCKRECS records or BLOCKMS milliseconds *
+ * so the index in the footer has one entry at least per 1 sec. *
+ * ------------------------------------------------------------ */
+#define BNO_LOG_MAGIC        "BNOL"
+#define BNO_LOG_VERSION      0x02
+#define BNO_LOG_HDRLEN       16
+#define BNO_LOG_BLKMAGIC     "BLK0"
+#define BNO_LOG_BLKHDRLEN    20
+#define BNO_LOG_IDXMAGIC     "BIDX"
+#define BNO_LOG_IDXLEN       20       // index entry: offset, time, recs
+#define BNO_LOG_ENDMAGIC     "BEND"
+#define BNO_LOG_ENDLEN       20       // trailer: index offset, last time
+#define BNO_LOG_BLOCKRECS    512      // max records per block
+#define BNO_LOG_BLOCKMS      1000     // max block duration in ms
+
+struct bnolog{
+   const unsigned char *map; // log file, mapped read-only
+   size_t size;        // log file size
+   int mask;           // channels stored in the log
+   int unitsel;        // SI unit selection at recording time
+   int nval;           // int16 values per record
+   int idx[BNO_RAW_COUNT]; // raw value index of each stored value
+   const unsigned char *index; // block index entries, NULL if none
+   int nblk;           // number of block index entries
+   int64_t first;      // time of the first record in usec
+   int64_t last;       // time of the last record in usec
+   size_t next;        // file offset of the next block
+   const unsigned char *blk; // current block payload
+   int blen;           // current block payload length
+   int bpos;           // decode position inside the block
+   int brec;           // records in the current block
+   int nrec;           // records decoded from the current block
+   struct bnoraw prev; // previous record, base for the deltas
+};
+
+extern int log_open(char*, int, int);     // start the log writer thread
+extern void log_write(struct bnoraw*);    // queue one record, no I/O
+extern int log_close();                   // flush blocks, write index
+extern int log_ropen(struct bnolog*, char*); // map a log for reading
+extern int log_read(struct bnolog*, struct bnoraw*); // next record
+extern int log_seek(struct bnolog*, int64_t); // go to time in usec
+extern void log_rclose(struct bnolog*);   // unmap the log file
+
+/* ------------------------------------------------------------ *
+ * Flight recorder ring file: a header followed by fixed size   *
+ * slots of raw samples. The file is mapped shared, so the data *
+ * survives a crash of the process. head counts all samples ever*
+ * written, slot i holds sample number i % nslot.               *
+ * ------------------------------------------------------------ */
+#define BNO_REC_MAGIC        "BNOR"
+#define BNO_REC_VERSION      0x01
+#define BNO_REC_MAXHZ        1000     // ring capacity in samples/sec
+#define BNO_REC_PRE          10       // default seconds before trigger
+#define BNO_REC_POST         2        // default seconds after trigger
+
+struct bnorechdr{
+   char magic[4];      // "BNOR"
+   uint32_t version;   // BNO_REC_VERSION
+   uint32_t nslot;     // number of slots in the ring
+   uint32_t unitsel;   // SI unit selection at recording time
+   uint64_t head;      // samples written, updated after each slot
+   int64_t trigger;    // time of a pending trigger in usec, 0 = none
+};
+
+struct bnorecslot{
+   int64_t us;         // sample time in usec
+   int16_t val[BNO_RAW_COUNT]; // raw values in register order
+};
+
+extern int rec_open(char*, int, int, double, int, int); // map the ring
+extern void rec_write(struct bnoraw*);    // copy one sample to the ring
+extern void rec_trigger();                // request an export, signal safe
+extern void rec_close();                  // wait for export, unmap ring
+extern void rec_report(FILE*);            // trigger counters
+extern int rec_load(char*, struct bnoraw**, int*); // read a ring file
@@ -0,0 +1,103 @@
+/* ------------------------------------------------------------ *
+ * file:        hist_bno055.c                                   *
+ * purpose:     Timing histograms for the continuous mode loop. *
+ *              HDR style: values in nsec go into log-linear    *
+ *              bins, 64 linear bins per power of two, so each  *
+ *              percentile is exact within 1.6%, from 1ns up to *
+ *              hours, at a constant cost of a few instructions *
+ *              per value and without any allocation.           *
+ *                                                              *
+ *              bus      I2C transaction time of bno_get_raw()  *
+ *              latency  sensor data update until output done   *
+ *              interval time between two new samples           *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "getbno055.h"
+
+#define HIST_SUBBITS   6                          // 64 bins per octave
+#define HIST_SUB       (1 << HIST_SUBBITS)
+#define HIST_BINS      ((64 - HIST_SUBBITS) * HIST_SUB)
+
+/* ------------------------------------------------------------ *
+ * One histogram. The loop is the only writer, readers (signal  *
+ * dump, HTTP thread) may see a sample half recorded, which is  *
+ * good enough for statistics and keeps the writer lock free.   *
+ * ------------------------------------------------------------ */
+struct bnohist {
+   const char *name;
+   uint64_t count;
+   uint64_t sum;
+   uint64_t max;
+   uint32_t bin[HIST_BINS];
+};
+
+static struct bnohist hist[BNO_HIST_COUNT] = {
+   { .name = "bus" }, { .name = "latency" }, { .name = "interval" }
+};
+
+/* ------------------------------------------------------------ *
+ * hist_index() maps a value to its bin: values below 2*SUB get *
+ * their own bin, above that each octave has SUB linear bins.   *
+ * ------------------------------------------------------------ */
+static int hist_index(uint64_t v) {
+   if(v < 2 * HIST_SUB) return(v);
+   int shift = 63 - __builtin_clzll(v) - HIST_SUBBITS;
+   return((shift + 1) * HIST_SUB + (v >> shift) - HIST_SUB);
+}
+
+/* ------------------------------------------------------------ *
+ * hist_value() returns the upper bound of the values in a bin  *
+ * ------------------------------------------------------------ */
+static uint64_t hist_value(int idx) {
+   if(idx < 2 * HIST_SUB) return(idx);
+   int shift = idx / HIST_SUB - 1;
+   return((((uint64_t) (idx % HIST_SUB + HIST_SUB) + 1) << shift) - 1);
+}
+
+/* ------------------------------------------------------------ *
+ * hist_add() records a value in nsec into histogram h          *
+ * ------------------------------------------------------------ */
+void hist_add(int h, int64_t ns) {
+   if(ns < 0) ns = 0;
+   struct bnohist *p = &hist[h];
+   p->bin[hist_index(ns)]++;
+   p->count++;
+   p->sum += ns;
+   if((uint64_t) ns > p->max) p->max = ns;
+}
+
+/* ------------------------------------------------------------ *
+ * hist_pct() returns the value at percentile pct (0..100)      *
+ * ------------------------------------------------------------ */
+static uint64_t hist_pct(struct bnohist *p, double pct) {
+   uint64_t rank = p->count * pct / 100.0, n = 0;
+   int i;
+   for(i = 0; i < HIST_BINS; i++) {
+      n += p->bin[i];
+      if(n > rank) break;
+   }
+   if(i == HIST_BINS) return(p->max);
+   uint64_t v = hist_value(i);
+   return(v > p->max ? p->max : v);
+}
+
+/* ------------------------------------------------------------ *
+ * hist_print() writes one line per histogram, values in usec:  *
+ * HIST bus n=1200 mean=412.3 p50=409.6 p99=470.0 ... max=612.1 *
+ * ------------------------------------------------------------ */
+void hist_print(FILE *fp) {
+   int i;
+   for(i = 0; i < BNO_HIST_COUNT; i++) {
+      struct bnohist *p = &hist[i];
+      if(p->count == 0) continue;
+      fprintf(fp, "HIST %-8s n=%llu mean=%.1f p50=%.1f p99=%.1f p99.9=%.1f max=%.1f (usec)\n",
+              p->name, (unsigned long long) p->count, p->sum / 1e3 / p->count,
+              hist_pct(p, 50) / 1e3, hist_pct(p, 99) / 1e3,
+              hist_pct(p, 99.9) / 1e3, p->max / 1e3);
+   }
+}
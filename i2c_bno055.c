@@ -12,157 +12,265 @@
  * ------------------------------------------------------------ */
 #include <stdio.h>
 #include <stdlib.h>
-#include <linux/i2c-dev.h>
-#include <sys/ioctl.h>
-#include <unistd.h>
-#include <fcntl.h>
+#include <string.h>
 #include "getbno055.h"
 
 /* ------------------------------------------------------------ *
- * global variables                                             *
+ * bno_open() opens the bus device, or "sim" for the simulated  *
+ * sensor, and checks that the sensor at addr answers. Returns  *
+ * 0, or -1 with the reason in bno_strerror().                  *
  * ------------------------------------------------------------ */
-int i2cfd;       // I2C file descriptor
+int bno_open(const char *dev, int addr) {
+   if(bno_debug == 1) printf("Debug: I2C bus device: [%s]\n", dev);
+   if(bno_debug == 1) printf("Debug: Sensor address: [0x%02X]\n", addr);
+
+   if(bno_bus_open(dev, addr) != 0) return(-1);
+   /* --------------------------------------------------------- *
+    * I2C communication test is the only way to confirm success *
+    * --------------------------------------------------------- */
+   char reg = BNO055_CHIP_ID_ADDR;
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure register [0x%02X], sensor addr [0x%02X]?\n", reg, addr);
+      bno_bus_close();
+      return(-1);
+   }
+   return(0);
+}
+
+void bno_close(void) {
+   bno_bus_close();
+}
 
 /* ------------------------------------------------------------ *
- * get_i2cbus() - Enables the I2C bus communication. Raspberry  *
- * Pi 2 uses i2c-1, RPI 1 used i2c-0, NanoPi also uses i2c-0.   *
+ * bno_read() reads len bytes from register reg of the current  *
+ * page in one burst, for callers that decode the data on their *
+ * own, e.g. bno055.hpp. Returns 0, or -1.                      *
  * ------------------------------------------------------------ */
-void get_i2cbus(char *i2cbus, char *i2caddr) {
-
-   if((i2cfd = open(i2cbus, O_RDWR)) < 0) {
-      printf("Error failed to open I2C bus [%s].\n", i2cbus);
-      exit(-1);
+int bno_read(int reg, void *buf, int len) {
+   char addr = reg;
+   if(bno_bus_write(&addr, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
+      return(-1);
+   }
+   if(bno_debug == 1) printf("Debug: I2C read %d bytes starting at register 0x%02X\n", len, reg);
+   if(bno_bus_read(buf, len) != len) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
+      return(-1);
    }
-   if(verbose == 1) printf("Debug: I2C bus device: [%s]\n", i2cbus);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_get_i2cbus() - Enables the I2C bus communication.        *
+ * Raspberry Pi 2 uses i2c-1, RPI 1 used i2c-0, NanoPi also     *
+ * uses i2c-0. The sensor address is the hex string of -a.      *
+ * ------------------------------------------------------------ */
+int bno_get_i2cbus(char *i2cbus, char *i2caddr) {
    /* --------------------------------------------------------- *
     * Set I2C device (BNO055 I2C address is  0x28 or 0x29)      *
     * --------------------------------------------------------- */
-   int addr = (int)strtol(i2caddr, NULL, 16);
-   if(verbose == 1) printf("Debug: Sensor address: [0x%02X]\n", addr);
+   return(bno_open(i2cbus, (int)strtol(i2caddr, NULL, 16)));
+}
 
-   if(ioctl(i2cfd, I2C_SLAVE, addr) != 0) {
-      printf("Error can't find sensor at address [0x%02X].\n", addr);
-      exit(-1);
-   }
-   /* --------------------------------------------------------- *
-    * I2C communication test is the only way to confirm success *
-    * --------------------------------------------------------- */
-   char reg = BNO055_CHIP_ID_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure register [0x%02X], sensor addr [0x%02X]?\n", reg, addr);
-      exit(-1);
+/* --------------------------------------------------------------- *
+ * bno_dump() reads the register map, each page with one 128 byte  *
+ * burst from register 0x00, and returns to page 0. Page switches  *
+ * take effect right away, they need no sleep.                     *
+ * --------------------------------------------------------------- */
+int bno_dump(struct bnoregs *regs) {
+   int page;
+
+   for(page = 0; page < 2; page++) {
+      if(page == 1 && bno_set_page1() != 0) return(-1);
+      char reg = 0x00;
+      if(bno_bus_write(&reg, 1) != 1) {
+         bno_error("I2C write failure for register 0x%02X\n", reg);
+         if(page == 1) bno_set_page0();
+         return(-1);
+      }
+      if(bno_bus_read(regs->page[page], BNO_PAGE_SIZE) != BNO_PAGE_SIZE) {
+         bno_error("I2C read failure for page %d register map\n", page);
+         if(page == 1) bno_set_page0();
+         return(-1);
+      }
    }
+   clock_gettime(CLOCK_REALTIME, &regs->ts);
+   if(bno_debug == 1) printf("Debug: Register map read, 2 pages of %d bytes\n", BNO_PAGE_SIZE);
+   return(bno_set_page0());
 }
 
 /* --------------------------------------------------------------- *
- * bno_dump() dumps the register map data.                         *
+ * bno_snapshot() reads the register map in CONFIG mode, where the *
+ * calibration registers are visible, and stores the operations    *
+ * mode that the sensor had before in OPR_MODE of the snapshot.    *
  * --------------------------------------------------------------- */
-int bno_dump() {
-   int count = 0;
-
-   printf("------------------------------------------------------\n");
-   printf("BNO055 page-0:\n");
-   printf("------------------------------------------------------\n");
-   printf(" reg    0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F\n");
-   printf("------------------------------------------------------\n");
-   while(count < 8) {
-      char reg = count;
-      if(write(i2cfd, &reg, 1) != 1) {
-         printf("Error: I2C write failure for register 0x%02X\n", reg);
-         exit(-1);
-      }
+int bno_snapshot(struct bnoregs *regs) {
+   int mode = bno_get_mode();
+   if(mode < 0 || bno_set_mode(BNO_MODE_CONFIG) != 0) return(-1);
+   int res = bno_dump(regs);
+   regs->page[0][BNO055_OPR_MODE_ADDR] = mode;
+   if(bno_set_mode(mode) != 0) return(-1);
+   return(res);
+}
+
+/* --------------------------------------------------------------- *
+ * Writable setup registers per page for bno_restore(): page 0 unit*
+ * select, power mode, clock source, temperature source, axis remap*
+ * SIC matrix, offsets and radius, page 1 the sensor and interrupt *
+ * configuration. OPR_MODE is written last, SYS_TRIGGER only with  *
+ * its clock select bit 7.                                         *
+ * --------------------------------------------------------------- */
+static int snap_writable(int page, int reg) {
+   if(page == 0) return(reg == BNO055_UNIT_SEL_ADDR || reg == BNO055_PWR_MODE_ADDR
+                        || (reg >= BNO055_TEMP_SOURCE_ADDR && reg <= MAG_RADIUS_MSB_ADDR));
+   return((reg >= BNO055_ACC_CONFIG_ADDR && reg <= BNO055_GYR_SLEEP_CONFIG_ADDR)
+          || (reg >= BNO055_INT_MSK_ADDR && reg <= BNO055_GYR_AM_SET_ADDR));
+}
 
-      char data[16] = {0};
-      if(read(i2cfd, &data, 16) != 16) {
-         printf("Error: I2C read failure for register 0x%02X\n", reg);
-         exit(-1);
-       
+/* --------------------------------------------------------------- *
+ * snap_write() writes the registers of one page that differ from  *
+ * the sensor, runs of changes with up to BNO_SNAP_GAP unchanged   *
+ * registers in between go in one burst. Returns the number of     *
+ * changed registers, or -1. *writes counts the transactions.      *
+ * --------------------------------------------------------------- */
+static int snap_write(int page, unsigned char *want, unsigned char *cur, int *writes) {
+   int reg = 0, changed = 0;
+
+   while(reg < BNO_PAGE_SIZE) {
+      if(! snap_writable(page, reg) || want[reg] == cur[reg]) { reg++; continue; }
+      int end = reg + 1, last = reg;
+      while(end < BNO_PAGE_SIZE && snap_writable(page, end) && end - last <= BNO_SNAP_GAP + 1) {
+         if(want[end] != cur[end]) last = end;
+         end++;
+      }
+      unsigned char buf[BNO_PAGE_SIZE + 1];
+      int i, len = last - reg + 1;
+      buf[0] = reg;
+      memcpy(buf + 1, want + reg, len);
+      for(i = reg; i <= last; i++) changed += want[i] != cur[i];
+      if(bno_debug == 1) printf("Debug: Restore page %d, %d bytes at register 0x%02X\n", page, len, reg);
+      if(bno_bus_write(buf, len + 1) != len + 1) {
+         bno_error("I2C write failure for register 0x%02X\n", reg);
+         return(-1);
       }
-      printf("[0x%02X] %02X %02X %02X %02X %02X %02X %02X %02X",
-             (reg*16), data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]);
-      printf(" %02X %02X %02X %02X %02X %02X %02X %02X\n",
-             data[8], data[9], data[10], data[11], data[12], data[13], data[14], data[15]);
-      count++;
-   }
-
-   set_page1();
-   usleep(50 * 1000);
-   count = 0;
-   printf("------------------------------------------------------\n");
-   printf("BNO055 page-1:\n");
-   printf("------------------------------------------------------\n");
-   printf(" reg    0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F\n");
-   printf("------------------------------------------------------\n");
-   while(count < 8) {
-      char reg = count;
-      if(write(i2cfd, &reg, 1) != 1) {
-         printf("Error: I2C write failure for register 0x%02X\n", reg);
-         exit(-1);
+      (*writes)++;
+      reg = last + 1;
+   }
+   return(changed);
+}
+
+/* --------------------------------------------------------------- *
+ * snap_apply() does the work of bno_restore() in CONFIG mode: it  *
+ * reads the register map, writes only the differing writable      *
+ * registers, page 0 first, then page 1, and verifies them with a  *
+ * second read. Returns the number of changed registers, or -1.    *
+ * --------------------------------------------------------------- */
+static int snap_apply(struct bnoregs *want, int *writes) {
+   struct bnoregs cur, check;
+   int changed = 0, n, page, reg;
+
+   if(bno_dump(&cur) != 0) return(-1);
+
+   if(((want->page[0][BNO055_SYS_TRIGGER_ADDR] ^ cur.page[0][BNO055_SYS_TRIGGER_ADDR]) & 0x80) != 0) {
+      char data[2] = { BNO055_SYS_TRIGGER_ADDR, want->page[0][BNO055_SYS_TRIGGER_ADDR] & 0x80 };
+      if(bno_bus_write(data, 2) != 2) {
+         bno_error("I2C write failure for register 0x%02X\n", data[0]);
+         return(-1);
       }
+      (*writes)++;
+      changed++;
+   }
+   if((n = snap_write(0, want->page[0], cur.page[0], writes)) < 0) return(-1);
+   changed += n;
+   if(bno_set_page1() != 0) return(-1);
+   n = snap_write(1, want->page[1], cur.page[1], writes);
+   if(bno_set_page0() != 0 || n < 0) return(-1);
+   changed += n;
 
-      char data[16] = {0};
-      if(read(i2cfd, &data, 16) != 16) {
-         printf("Error: I2C read failure for register 0x%02X\n", reg);
-         exit(-1);
-       
+   /* ------------------------------------------------------------ *
+    * verify, only when something was written                      *
+    * ------------------------------------------------------------ */
+   if(changed > 0) {
+      if(bno_dump(&check) != 0) return(-1);
+      for(page = 0; page < 2; page++) {
+         for(reg = 0; reg < BNO_PAGE_SIZE; reg++) {
+            if(! snap_writable(page, reg) || want->page[page][reg] == check.page[page][reg]) continue;
+            bno_error("Restore failure page %d register 0x%02X: %02X, expected %02X\n",
+                   page, reg, check.page[page][reg], want->page[page][reg]);
+            return(-1);
+         }
       }
-      printf("[0x%02X] %02X %02X %02X %02X %02X %02X %02X %02X",
-             (reg*16), data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]);
-      printf(" %02X %02X %02X %02X %02X %02X %02X %02X\n",
-             data[8], data[9], data[10], data[11], data[12], data[13], data[14], data[15]);
-      count++;
    }
+   return(changed);
+}
 
-   set_page0();
-   usleep(50 * 1000);
-   exit(0);
+/* --------------------------------------------------------------- *
+ * bno_restore() brings the sensor setup to the state of a snapshot*
+ * with snap_apply() in one CONFIG mode window, and then sets the  *
+ * snapshot mode. On a failure, the sensor is also put back on     *
+ * page 0 and into the snapshot mode, so that it does not stay     *
+ * stopped in CONFIG mode. Returns the changed registers, or -1.   *
+ * --------------------------------------------------------------- */
+int bno_restore(struct bnoregs *want) {
+   int mode = want->page[0][BNO055_OPR_MODE_ADDR] & 0x0F;
+   int writes = 0, changed = -1;
+
+   if(bno_set_mode(BNO_MODE_CONFIG) == 0) changed = snap_apply(want, &writes);
+   if(changed < 0) {
+      bno_set_page0();
+      bno_set_mode(mode);
+      return(-1);
+   }
+   if(bno_debug == 1) printf("Debug: Restore changed %d registers in %d writes\n", changed, writes);
+   if(bno_set_mode(mode) != 0) return(-1);
+   return(changed);
 }
 
 /* --------------------------------------------------------------- *
  * bno_reset() resets the sensor. It will come up in CONFIG mode.  *
  * --------------------------------------------------------------- */
-int bno_reset() {
+int bno_reset(void) {
    char data[2];
    data[0] = BNO055_SYS_TRIGGER_ADDR;
    data[1] = 0x20;
-   if(write(i2cfd, data, 2) != 2) {
-      printf("Error: I2C write failure for register 0x%02X\n", data[0]);
-      exit(-1);
+   if(bno_bus_write(data, 2) != 2) {
+      bno_error("I2C write failure for register 0x%02X\n", data[0]);
+      return(-1);
    }
-   if(verbose == 1) printf("Debug: BNO055 Sensor Reset complete\n");
+   if(bno_debug == 1) printf("Debug: BNO055 Sensor Reset complete\n");
    
    /* ------------------------------------------------------------ *
     * After a reset, the sensor needs at leat 650ms to boot up.    *
     * ------------------------------------------------------------ */
-   usleep(650 * 1000);
-   exit(0);
+   bno_bus_sleep(650 * 1000, __func__);
+   return(0);
 }
 
 /* ------------------------------------------------------------ *
- * get_calstatus() gets the calibration state from the sensor. *
- * Calibration status has 4 values, encoded as 2bit in reg 0x35 *
+ * bno_get_calstatus() gets the calibration state from the      *
+ * sensor. Calibration status has 4 values, 2bit in reg 0x35    *
  * ------------------------------------------------------------ */
-int get_calstatus(struct bnocal *bno_ptr) {
+int bno_get_calstatus(struct bnocal *bno_ptr) {
    char reg = BNO055_CALIB_STAT_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    char data = 0;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register 0x%02X\n", reg);
+   if(bno_bus_read(&data, 1) != 1) {
+      bno_error("I2C read failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    bno_ptr->scal_st = (data & 0b11000000) >> 6; // system calibration status
-   if(verbose == 1) printf("Debug: sensor system calibration: [%d]\n", bno_ptr->scal_st);
+   if(bno_debug == 1) printf("Debug: sensor system calibration: [%d]\n", bno_ptr->scal_st);
    bno_ptr->gcal_st = (data & 0b00110000) >> 4; // gyro calibration
-   if(verbose == 1) printf("Debug:     gyroscope calibration: [%d]\n", bno_ptr->gcal_st);
+   if(bno_debug == 1) printf("Debug:     gyroscope calibration: [%d]\n", bno_ptr->gcal_st);
    bno_ptr->acal_st = (data & 0b00001100) >> 2; // accel calibration status
-   if(verbose == 1) printf("Debug: accelerometer calibration: [%d]\n", bno_ptr->acal_st);
+   if(bno_debug == 1) printf("Debug: accelerometer calibration: [%d]\n", bno_ptr->acal_st);
    bno_ptr->mcal_st = (data & 0b00000011);      // magneto calibration status
-   if(verbose == 1) printf("Debug:  magnetometer calibration: [%d]\n", bno_ptr->mcal_st);
+   if(bno_debug == 1) printf("Debug:  magnetometer calibration: [%d]\n", bno_ptr->mcal_st);
    return(0);
 }
 
@@ -170,27 +278,29 @@ int get_calstatus(struct bnocal *bno_ptr) {
  * Calibration offset is stored in 3x6 (18) registers 0x55~0x66 *
  * plus 4 registers 0x67~0x6A accelerometer/magnetometer radius *
  * ------------------------------------------------------------ */
-int get_caloffset(struct bnocal *bno_ptr) {
+int bno_get_caloffset(struct bnocal *bno_ptr) {
    /* --------------------------------------------------------- *
     * Registers may not update in fusion mode, switch to CONFIG *
     * --------------------------------------------------------- */
-   opmode_t oldmode = get_mode();
-   set_mode(config);
+   bno_opmode_t oldmode = bno_get_mode();
+   bno_set_mode(BNO_MODE_CONFIG);
 
    char reg = ACC_OFFSET_X_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
+      bno_set_mode(oldmode);
       return(-1);
    }
 
-   if(verbose == 1) printf("Debug: I2C read %d bytes starting at register 0x%02X\n", CALIB_BYTECOUNT, reg);
+   if(bno_debug == 1) printf("Debug: I2C read %d bytes starting at register 0x%02X\n", CALIB_BYTECOUNT, reg);
 
    char data[CALIB_BYTECOUNT] = {0};
-   if(read(i2cfd, data, CALIB_BYTECOUNT) != CALIB_BYTECOUNT) {
-      printf("Error: I2C calibration data read from 0x%02X\n", reg);
+   if(bno_bus_read(data, CALIB_BYTECOUNT) != CALIB_BYTECOUNT) {
+      bno_error("I2C calibration data read from 0x%02X\n", reg);
+      bno_set_mode(oldmode);
       return(-1);
    }
-   if(verbose == 1) {
+   if(bno_debug == 1) {
       int i = 0;
       printf("Debug: Calibrationset:");
       while(i<CALIB_BYTECOUNT) {
@@ -204,7 +314,7 @@ int get_caloffset(struct bnocal *bno_ptr) {
     * assigning accelerometer X-Y-Z offset, range per G-range      *
     * 16G = +/-16000, 8G = +/-8000, 4G = +/-4000, 2G = +/-2000     *
     * ------------------------------------------------------------ */
-   if(verbose == 1) printf("Debug: accelerometer offset: [%d] [%d] [%d] (X-Y-Z)\n",
+   if(bno_debug == 1) printf("Debug: accelerometer offset: [%d] [%d] [%d] (X-Y-Z)\n",
 		           ((int16_t)data[1] << 8) | data[0],
                            ((int16_t)data[3] << 8) | data[2],
                            ((int16_t)data[5] << 8) | data[4]);
@@ -215,7 +325,7 @@ int get_caloffset(struct bnocal *bno_ptr) {
    /* ------------------------------------------------------------ *
     * assigning magnetometer X-Y-Z offset, offset range is +/-6400 *
     * ------------------------------------------------------------ */
-   if(verbose == 1) printf("Debug:  magnetometer offset: [%d] [%d] [%d] (X-Y-Z)\n",
+   if(bno_debug == 1) printf("Debug:  magnetometer offset: [%d] [%d] [%d] (X-Y-Z)\n",
                            ((int16_t)data[7] << 8) | data[6],
                            ((int16_t)data[9] << 8) | data[8],
                            ((int16_t)data[11] << 8) | data[10]);
@@ -227,7 +337,7 @@ int get_caloffset(struct bnocal *bno_ptr) {
     * assigning gyroscope X-Y-Z offset, range depends on dps value *
     * 2000 = +/-32000, 1000 = +/-16000, 500 = +/-8000, etc         *
     * ------------------------------------------------------------ */
-   if(verbose == 1) printf("Debug:     gyroscope offset: [%d] [%d] [%d] (X-Y-Z)\n",
+   if(bno_debug == 1) printf("Debug:     gyroscope offset: [%d] [%d] [%d] (X-Y-Z)\n",
                            ((int16_t)data[13] << 8) | data[12],
                            ((int16_t)data[15] << 8) | data[14],
                            ((int16_t)data[17] << 8) | data[16]);
@@ -238,48 +348,50 @@ int get_caloffset(struct bnocal *bno_ptr) {
    /* ------------------------------------------------------------ *
     * assigning accelerometer radius, range is +/-1000             *
     * ------------------------------------------------------------ */
-   if(verbose == 1) printf("Debug: accelerometer radius: [%d] (+/-1000)\n",
+   if(bno_debug == 1) printf("Debug: accelerometer radius: [%d] (+/-1000)\n",
                            ((int16_t)data[19] << 8) | data[18]);
    bno_ptr->acc_rad = ((int16_t)data[19] << 8) | data[18];
 
    /* ------------------------------------------------------------ *
     * assigning magnetometer radius, range is +/-960               *
     * ------------------------------------------------------------ */
-   if(verbose == 1) printf("Debug:  magnetometer radius: [%d] (+/- 960)\n",
+   if(bno_debug == 1) printf("Debug:  magnetometer radius: [%d] (+/- 960)\n",
                            ((int16_t)data[21] << 8) | data[20]);
    bno_ptr->mag_rad = ((int16_t)data[21] << 8) | data[20];
-   set_mode(oldmode);
+   bno_set_mode(oldmode);
    return(0);
 }
 
 /* ------------------------------------------------------------ *
- * save_cal() - writes calibration data to file for reuse       *
+ * bno_save_cal() - writes calibration data to file for reuse   *
  * ------------------------------------------------------------ */
-int save_cal(char *file) {
+int bno_save_cal(const char *file) {
    /* --------------------------------------------------------- *
     * Read 34 bytes calibration data from registers 0x43~66,    *
     * plus 4 reg 0x67~6A with accelerometer/magnetometer radius *
     * switch to CONFIG, data is only visible in non-fusion mode *
     * --------------------------------------------------------- */
-   opmode_t oldmode = get_mode();
-   set_mode(config);
+   bno_opmode_t oldmode = bno_get_mode();
+   bno_set_mode(BNO_MODE_CONFIG);
    int i = 0;
    //char reg = ACC_OFFSET_X_LSB_ADDR;
    char reg = BNO055_SIC_MATRIX_0_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
+      bno_set_mode(oldmode);
       return(-1);
    }
 
-   if(verbose == 1) printf("Debug: I2C read %d bytes starting at register 0x%02X\n",
+   if(bno_debug == 1) printf("Debug: I2C read %d bytes starting at register 0x%02X\n",
                            CALIB_BYTECOUNT, reg);
 
    char data[CALIB_BYTECOUNT] = {0};
-   if(read(i2cfd, data, CALIB_BYTECOUNT) != CALIB_BYTECOUNT) {
-      printf("Error: I2C calibration data read from 0x%02X\n", reg);
+   if(bno_bus_read(data, CALIB_BYTECOUNT) != CALIB_BYTECOUNT) {
+      bno_error("I2C calibration data read from 0x%02X\n", reg);
+      bno_set_mode(oldmode);
       return(-1);
    }
-   if(verbose == 1) {
+   if(bno_debug == 1) {
       printf("Debug: Calibrationset:");
       while(i<CALIB_BYTECOUNT) {
          printf(" %02X", data[i]);
@@ -293,38 +405,39 @@ int save_cal(char *file) {
     * -------------------------------------------------------- */
    FILE *calib;
    if(! (calib=fopen(file, "w"))) {
-      printf("Error: Can't open %s for writing.\n", file);
-      exit(-1);
+      bno_error("Can't open %s for writing.\n", file);
+      bno_set_mode(oldmode);
+      return(-1);
    }
-   if(verbose == 1) printf("Debug:  Write to file: [%s]\n", file);
+   if(bno_debug == 1) printf("Debug:  Write to file: [%s]\n", file);
 
    /* -------------------------------------------------------- *
     * write the bytes in data[] out                            *
     * -------------------------------------------------------- */
    int outbytes = fwrite(data, 1, CALIB_BYTECOUNT, calib);
    fclose(calib);
-   if(verbose == 1) printf("Debug:  Bytes to file: [%d]\n", outbytes);
+   if(bno_debug == 1) printf("Debug:  Bytes to file: [%d]\n", outbytes);
+   bno_set_mode(oldmode);
    if(outbytes != CALIB_BYTECOUNT) {
-      printf("Error: %d/%d bytes written to file.\n", outbytes, CALIB_BYTECOUNT);
+      bno_error("%d/%d bytes written to file.\n", outbytes, CALIB_BYTECOUNT);
       return(-1);
    }
-   set_mode(oldmode);
    return(0);
 }
 
 /* ------------------------------------------------------------ *
- * load_cal() load previously saved calibration data from file  *
+ * bno_load_cal() load saved calibration data from file         *
  * ------------------------------------------------------------ */
-int load_cal(char *file) {
+int bno_load_cal(const char *file) {
    /* -------------------------------------------------------- *
     *  Open the calibration data file for reading.             *
     * -------------------------------------------------------- */
    FILE *calib;
    if(! (calib=fopen(file, "r"))) {
-      printf("Error: Can't open %s for reading.\n", file);
-      exit(-1);
+      bno_error("Can't open %s for reading.\n", file);
+      return(-1);
    }
-   if(verbose == 1) printf("Debug: Load from file: [%s]\n", file);
+   if(bno_debug == 1) printf("Debug: Load from file: [%s]\n", file);
 
    /* -------------------------------------------------------- *
     * Read 34 bytes from file into data[], starting at data[1] *
@@ -336,10 +449,10 @@ int load_cal(char *file) {
    fclose(calib);
 
    if(inbytes != CALIB_BYTECOUNT) {
-      printf("Error: %d/%d bytes read to file.\n", inbytes, CALIB_BYTECOUNT);
+      bno_error("%d/%d bytes read to file.\n", inbytes, CALIB_BYTECOUNT);
       return(-1);
    }
-   if(verbose == 1) {
+   if(bno_debug == 1) {
       printf("Debug: Calibrationset:");
       int i = 1;
       while(i<CALIB_BYTECOUNT+1) {
@@ -353,12 +466,12 @@ int load_cal(char *file) {
     * Write 34 bytes from file into sensor registers from 0x43 *
     * We need to switch in and out of CONFIG mode if needed... *
     * -------------------------------------------------------- */
-   opmode_t oldmode = get_mode();
-   set_mode(config);
-   usleep(50 * 1000);
+   bno_opmode_t oldmode = bno_get_mode();
+   bno_set_mode(BNO_MODE_CONFIG);
 
-   if(write(i2cfd, data, (CALIB_BYTECOUNT+1)) != (CALIB_BYTECOUNT+1)) {
-      printf("Error: I2C write failure for register 0x%02X\n", data[0]);
+   if(bno_bus_write(data, (CALIB_BYTECOUNT+1)) != (CALIB_BYTECOUNT+1)) {
+      bno_error("I2C write failure for register 0x%02X\n", data[0]);
+      bno_set_mode(oldmode);
       return(-1);
    }
 
@@ -367,42 +480,44 @@ int load_cal(char *file) {
     * -------------------------------------------------------- */
    //char reg = ACC_OFFSET_X_LSB_ADDR;
    char reg = BNO055_SIC_MATRIX_0_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
+      bno_set_mode(oldmode);
       return(-1);
    }
 
    char newdata[CALIB_BYTECOUNT] = {0};
-   if(read(i2cfd, newdata, CALIB_BYTECOUNT) != CALIB_BYTECOUNT) {
-      printf("Error: I2C calibration data read from 0x%02X\n", reg);
+   if(bno_bus_read(newdata, CALIB_BYTECOUNT) != CALIB_BYTECOUNT) {
+      bno_error("I2C calibration data read from 0x%02X\n", reg);
+      bno_set_mode(oldmode);
       return(-1);
    }
 
-   if(verbose == 1) printf("Debug: Registerupdate:");
+   if(bno_debug == 1) printf("Debug: Registerupdate:");
    int i = 0;
    while(i<CALIB_BYTECOUNT) {
       if(data[i+1] != newdata[i]) {
-         printf("\nError: Calibration load failure %02X register 0x%02X\n", newdata[i], reg+i);
+         bno_error("Calibration load failure %02X register 0x%02X\n", newdata[i], reg+i);
          //exit(-1);
       }
-      if(verbose == 1) printf(" %02X", newdata[i]);
+      if(bno_debug == 1) printf(" %02X", newdata[i]);
       i++;
    }
-   if(verbose == 1) printf("\n");
-   set_mode(oldmode);
+   if(bno_debug == 1) printf("\n");
+   bno_set_mode(oldmode);
 
    /* -------------------------------------------------------- *
     * 650 ms delay are only needed if -l and -t are both used  *
     * to let the fusion code process the new calibration data  *
     * -------------------------------------------------------- */
-   usleep(650 * 1000);
+   bno_bus_sleep(650 * 1000, __func__);
    return(0);
 }
 
 /* ------------------------------------------------------------ *
- * print_unit() - Extract the SI unit config from register 0x3B *
+ * bno_print_unit() - Extract the SI unit config from reg 0x3B  *
  * ------------------------------------------------------------ */
-void print_unit(int unit_sel) {
+void bno_print_unit(int unit_sel) {
    // bit-0
    printf("Acceleration Unit  = ");
    if((unit_sel >> 0) & 0x01) printf("mg\n");
@@ -433,149 +548,149 @@ void print_unit(int unit_sel) {
 }
 
 /* ------------------------------------------------------------ *
- * get_inf() queries the BNO055 and write the info data into    *
+ * bno_get_inf() queries the BNO055 and write the info data into*
  * the global struct bnoinf defined in getbno055.h              *
  * ------------------------------------------------------------ */
-int get_inf(struct bnoinf *bno_ptr) {
+int bno_get_inf(struct bnoinf *bno_ptr) {
    char reg = 0x00;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    char data[7] = {0};
-   if(read(i2cfd, data, 7) != 7) {
-      printf("Error: I2C read failure for register data 0x00-0x06\n");
+   if(bno_bus_read(data, 7) != 7) {
+      bno_error("I2C read failure for register data 0x00-0x06\n");
       return(-1);
    }
    /* --------------------------------------------------------- *
     * 1-byte chip ID in register 0x00, default: 0xA0            *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: Sensor CHIP ID: [0x%02X]\n", data[0]);
+   if(bno_debug == 1) printf("Debug: Sensor CHIP ID: [0x%02X]\n", data[0]);
    bno_ptr->chip_id = data[0];
 
    /* --------------------------------------------------------- *
     * 1-byte Accelerometer ID in register 0x01, default: 0xFB   *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: Sensor  ACC ID: [0x%02X]\n", data[1]);
+   if(bno_debug == 1) printf("Debug: Sensor  ACC ID: [0x%02X]\n", data[1]);
    bno_ptr->acc_id = data[1];
 
    /* --------------------------------------------------------- *
     * 1-byte Magnetometer ID in register 0x02, default 0x32     *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: Sensor  MAG ID: [0x%02X]\n", data[2]);
+   if(bno_debug == 1) printf("Debug: Sensor  MAG ID: [0x%02X]\n", data[2]);
    bno_ptr->mag_id = data[2];
 
    /* --------------------------------------------------------- *
     * 1-byte Gyroscope ID in register 0x03, default: 0x0F       *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: Sensor  GYR ID: [0x%02X]\n", data[3]);
+   if(bno_debug == 1) printf("Debug: Sensor  GYR ID: [0x%02X]\n", data[3]);
    bno_ptr->gyr_id = data[3];
 
    /* --------------------------------------------------------- *
     * 1-byte SW Revsion ID LSB in register 0x04, default: 0x08  *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: SW  Rev-ID LSB: [0x%02X]\n", data[4]);
+   if(bno_debug == 1) printf("Debug: SW  Rev-ID LSB: [0x%02X]\n", data[4]);
    bno_ptr->sw_lsb = data[4];
 
    /* --------------------------------------------------------- *
     * 1-byte SW Revision ID MSB in register 0x05, default: 0x03 *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: SW  Rev-ID MSB: [0x%02X]\n", data[5]);
+   if(bno_debug == 1) printf("Debug: SW  Rev-ID MSB: [0x%02X]\n", data[5]);
    bno_ptr->sw_msb = data[5];
 
    /* --------------------------------------------------------- *
     * 1-byte BootLoader Revision ID register 0x06, no default   *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: Bootloader Ver: [0x%02X]\n", data[6]);
+   if(bno_debug == 1) printf("Debug: Bootloader Ver: [0x%02X]\n", data[6]);
    bno_ptr->bl_rev = data[6];
 
    /* --------------------------------------------------------- *
-    * Read the operations mode with get_mode(), default: 0x0    *
+    * Read the operations mode with bno_get_mode(), default: 0x0*
     * --------------------------------------------------------- */
-   bno_ptr->opr_mode = get_mode();
+   bno_ptr->opr_mode = bno_get_mode();
 
    /* --------------------------------------------------------- *
-    * Read the power mode with get_power(), default: 0x0        *
+    * Read the power mode with bno_get_power(), default: 0x0    *
     * --------------------------------------------------------- */
-   bno_ptr->pwr_mode = get_power();
+   bno_ptr->pwr_mode = bno_get_power();
 
    /* --------------------------------------------------------- *
-    * Read the axis remap config get_remap('c'), default: 0x24  *
+    * Read the axis remap config bno_get_remap('c'), def: 0x24  *
     * --------------------------------------------------------- */
-   bno_ptr->axr_conf = get_remap('c');
+   bno_ptr->axr_conf = bno_get_remap('c');
 
    /* --------------------------------------------------------- *
-    * Read the axis remap sign get_remap('s'), default: 0x00    *
+    * Read the axis remap sign bno_get_remap('s'), default: 0x00*
     * --------------------------------------------------------- */
-   bno_ptr->axr_sign = get_remap('s');
+   bno_ptr->axr_sign = bno_get_remap('s');
 
    /* --------------------------------------------------------- *
     * Read 1-byte system status from register 0x39, no default  *
     * --------------------------------------------------------- */
    reg = BNO055_SYS_STAT_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    data[0] = 0;
-   if(read(i2cfd, data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
-   if(verbose == 1) printf("Debug:  System Status: [0x%02X]\n", data[0]);
+   if(bno_debug == 1) printf("Debug:  System Status: [0x%02X]\n", data[0]);
    bno_ptr->sys_stat = data[0];
 
    /* --------------------------------------------------------- *
     * Read 1-byte Self Test Result register 0x36, 0x0F=pass     *
     * --------------------------------------------------------- */
    reg = BNO055_SELFTSTRES_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    data[0] = 0;
-   if(read(i2cfd, data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
-   if(verbose == 1) printf("Debug: Self-Test Mode: [0x%02X] 4bit [0x%02X]\n", data[0], data[0] & 0x0F);
+   if(bno_debug == 1) printf("Debug: Self-Test Mode: [0x%02X] 4bit [0x%02X]\n", data[0], data[0] & 0x0F);
    bno_ptr->selftest = data[0] & 0x0F; // only get the lowest 4 bits
 
    /* --------------------------------------------------------- *
     * Read 1-byte System Error from register 0x3A, 0=OK         *
     * --------------------------------------------------------- */
    reg = BNO055_SYS_ERR_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    data[0] = 0;
-   if(read(i2cfd, data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
-   if(verbose == 1) printf("Debug: Internal Error: [0x%02X]\n", data[0]);
+   if(bno_debug == 1) printf("Debug: Internal Error: [0x%02X]\n", data[0]);
    bno_ptr->sys_err = data[0];
 
    /* --------------------------------------------------------- *
     * Read 1-byte Unit definition from register 0x3B, 0=OK      *
     * --------------------------------------------------------- */
    reg = BNO055_UNIT_SEL_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    data[0] = 0;
-   if(read(i2cfd, data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
-   if(verbose == 1) printf("Debug: UnitDefinition: [0x%02X]\n", data[0]);
+   if(bno_debug == 1) printf("Debug: UnitDefinition: [0x%02X]\n", data[0]);
    bno_ptr->unitsel = data[0];
 
    /* --------------------------------------------------------- *
@@ -589,195 +704,195 @@ int get_inf(struct bnoinf *bno_ptr) {
     * Read sensor temperature from register 0x34, no default    *
     * --------------------------------------------------------- */
    reg = BNO055_TEMP_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    data[0] = 0;
-   if(read(i2cfd, data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
-   if(verbose == 1) printf("Debug:    Temperature: [0x%02X] [%d°%c]\n", data[0], data[0], t_unit);
+   if(bno_debug == 1) printf("Debug:    Temperature: [0x%02X] [%d°%c]\n", data[0], data[0], t_unit);
    bno_ptr->temp_val = data[0];
 
    return(0);
 }
 /* ------------------------------------------------------------ *
- *  get_acc() - read accelerometer data into the global struct  *
+ *  bno_get_acc() - read accelerometer data into the struct     *
  * ------------------------------------------------------------ */
-int get_acc(struct bnoacc *bnod_ptr) {
+int bno_get_acc(struct bnoacc *bnod_ptr) {
    char reg = BNO055_ACC_DATA_X_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    char data[6] = {0};
-   if(read(i2cfd, data, 6) != 6) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(data, 6) != 6) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
 
    int16_t buf = ((int16_t)data[1] << 8) | data[0];
-   if(verbose == 1) printf("Debug: Accelerometer Data X: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
+   if(bno_debug == 1) printf("Debug: Accelerometer Data X: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
    bnod_ptr->adata_x = (double) buf;
 
    buf = ((int16_t)data[3] << 8) | data[2];
-   if(verbose == 1) printf("Debug: Accelerometer Data Y: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
+   if(bno_debug == 1) printf("Debug: Accelerometer Data Y: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
    bnod_ptr->adata_y = (double) buf;
 
    buf = ((int16_t)data[5] << 8) | data[4];
-   if(verbose == 1) printf("Debug: Accelerometer Data Z: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
+   if(bno_debug == 1) printf("Debug: Accelerometer Data Z: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
    bnod_ptr->adata_z = (double) buf;
    return(0);
 }
 
 /* ------------------------------------------------------------ *
- *  get_mag() - read magnetometer data into the global struct   *
+ *  bno_get_mag() - read magnetometer data into the struct      *
  *  Convert magnetometer data in microTesla. 1 microTesla = 16  *
  * ------------------------------------------------------------ */
-int get_mag(struct bnomag *bnod_ptr) {
+int bno_get_mag(struct bnomag *bnod_ptr) {
    char reg = BNO055_MAG_DATA_X_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    char data[6] = {0};
-   if(read(i2cfd, data, 6) != 6) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(data, 6) != 6) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
 
    int16_t buf = ((int16_t)data[1] << 8) | data[0]; 
-   if(verbose == 1) printf("Debug: Magnetometer Data X: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
+   if(bno_debug == 1) printf("Debug: Magnetometer Data X: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
    bnod_ptr->mdata_x = (double) buf / 1.6;
 
    buf = ((int16_t)data[3] << 8) | data[2]; 
-   if(verbose == 1) printf("Debug: Magnetometer Data Y: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
+   if(bno_debug == 1) printf("Debug: Magnetometer Data Y: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
    bnod_ptr->mdata_y = (double) buf / 1.6;
 
    buf = ((int16_t)data[5] << 8) | data[4]; 
-   if(verbose == 1) printf("Debug: Magnetometer Data Z: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
+   if(bno_debug == 1) printf("Debug: Magnetometer Data Z: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
    bnod_ptr->mdata_z = (double) buf / 1.6;
    return(0);
 }
 
 /* ------------------------------------------------------------ *
- *  get_gyr() - read gyroscope data into the global struct      *
+ *  bno_get_gyr() - read gyroscope data into the global struct  *
  * ------------------------------------------------------------ */
-int get_gyr(struct bnogyr *bnod_ptr) {
+int bno_get_gyr(struct bnogyr *bnod_ptr) {
    char reg = BNO055_GYRO_DATA_X_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    char data[6] = {0};
-   if(read(i2cfd, data, 6) != 6) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(data, 6) != 6) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
 
    int16_t buf = ((int16_t)data[1] << 8) | data[0];
-   if(verbose == 1) printf("Debug: Gyroscope Data X: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
+   if(bno_debug == 1) printf("Debug: Gyroscope Data X: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
    bnod_ptr->gdata_x = (double) buf / 16.0;
 
    buf = ((int16_t)data[3] << 8) | data[2];
-   if(verbose == 1) printf("Debug: Gyrosscope Data Y: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
+   if(bno_debug == 1) printf("Debug: Gyrosscope Data Y: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
    bnod_ptr->gdata_y = (double) buf / 16.0;
 
    buf = ((int16_t)data[5] << 8) | data[4];
-   if(verbose == 1) printf("Debug: Gyroscope Data Z: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
+   if(bno_debug == 1) printf("Debug: Gyroscope Data Z: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
    bnod_ptr->gdata_z = (double) buf / 16.0;
    return(0);
 }
 
 /* ------------------------------------------------------------ *
- *  get_eul() - read Euler orientation into the global struct   *
+ *  bno_get_eul() - read Euler orientation into the struct      *
  * ------------------------------------------------------------ */
-int get_eul(struct bnoeul *bnod_ptr) {
+int bno_get_eul(struct bnoeul *bnod_ptr) {
    char reg = BNO055_EULER_H_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
-   if(verbose == 1) printf("Debug: I2C read 6 bytes starting at register 0x%02X\n", reg);
+   if(bno_debug == 1) printf("Debug: I2C read 6 bytes starting at register 0x%02X\n", reg);
 
    unsigned char data[6] = {0, 0, 0, 0, 0, 0};
-   if(read(i2cfd, data, 6) != 6) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(data, 6) != 6) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
 
    int16_t buf = ((int16_t)data[1] << 8) | data[0]; 
-   if(verbose == 1) printf("Debug: Euler Orientation H: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
+   if(bno_debug == 1) printf("Debug: Euler Orientation H: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
    bnod_ptr->eul_head = (double) buf / 16.0;
 
    buf = ((int16_t)data[3] << 8) | data[2]; 
-   if(verbose == 1) printf("Debug: Euler Orientation R: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
+   if(bno_debug == 1) printf("Debug: Euler Orientation R: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
    bnod_ptr->eul_roll = (double) buf / 16.0;
 
    buf = ((int16_t)data[5] << 8) | data[4]; 
-   if(verbose == 1) printf("Debug: Euler Orientation P: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
+   if(bno_debug == 1) printf("Debug: Euler Orientation P: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
    bnod_ptr->eul_pitc = (double) buf / 16.0;
    return(0);
 }
 
 /* ------------------------------------------------------------ *
- *  get_qua() - read Quaternation data into the global struct   *
+ *  bno_get_qua() - read Quaternation data into the struct      *
  * ------------------------------------------------------------ */
-int get_qua(struct bnoqua *bnod_ptr) {
+int bno_get_qua(struct bnoqua *bnod_ptr) {
    char reg = BNO055_QUATERNION_DATA_W_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
-   if(verbose == 1) printf("Debug: I2C read 8 bytes starting at register 0x%02X\n", reg);
+   if(bno_debug == 1) printf("Debug: I2C read 8 bytes starting at register 0x%02X\n", reg);
 
    unsigned char data[8] = {0};
-   if(read(i2cfd, data, 8) != 8) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(data, 8) != 8) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
 
    int16_t buf = ((int16_t)data[1] << 8) | data[0]; 
-   if(verbose == 1) printf("Debug: Quaternation W: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
+   if(bno_debug == 1) printf("Debug: Quaternation W: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
    bnod_ptr->quater_w = (double) buf / 16384.0;
 
    buf = ((int16_t)data[3] << 8) | data[2]; 
-   if(verbose == 1) printf("Debug: Quaternation X: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
+   if(bno_debug == 1) printf("Debug: Quaternation X: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
    bnod_ptr->quater_x = (double) buf / 16384.0;
 
    buf = ((int16_t)data[5] << 8) | data[4]; 
-   if(verbose == 1) printf("Debug: Quaternation Y: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
+   if(bno_debug == 1) printf("Debug: Quaternation Y: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
    bnod_ptr->quater_y = (double) buf / 16384.0;
 
    buf = ((int16_t)data[7] << 8) | data[6]; 
-   if(verbose == 1) printf("Debug: Quaternation Z: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[6], data[7],buf);
+   if(bno_debug == 1) printf("Debug: Quaternation Z: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[6], data[7],buf);
    bnod_ptr->quater_z = (double) buf / 16384.0;
    return(0);
 }
 
 /* ------------------------------------------------------------ *
- *  get_gra() - read gravity vector into the global struct      *
+ *  bno_get_gra() - read gravity vector into the global struct  *
  * ------------------------------------------------------------ */
-int get_gra(struct bnogra *bnod_ptr) {
+int bno_get_gra(struct bnogra *bnod_ptr) {
    /* --------------------------------------------------------- *
     * Get the unit conversion: 1 m/s2 = 100 LSB, 1 mg = 1 LSB   *
     * --------------------------------------------------------- */
    char reg = BNO055_UNIT_SEL_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
    char unit_sel;
-   if(read(i2cfd, &unit_sel, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(&unit_sel, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
 
@@ -789,48 +904,48 @@ int get_gra(struct bnogra *bnod_ptr) {
     * Get the gravity vector data                               *
     * --------------------------------------------------------- */
    reg = BNO055_GRAVITY_DATA_X_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
-   if(verbose == 1) printf("Debug: I2C read 6 bytes starting at register 0x%02X\n", reg);
+   if(bno_debug == 1) printf("Debug: I2C read 6 bytes starting at register 0x%02X\n", reg);
 
    unsigned char data[6] = {0, 0, 0, 0, 0, 0};
-   if(read(i2cfd, data, 6) != 6) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(data, 6) != 6) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
 
    int16_t buf = ((int16_t)data[1] << 8) | data[0];
-   if(verbose == 1) printf("Debug: Gravity Vector H: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
+   if(bno_debug == 1) printf("Debug: Gravity Vector H: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
    bnod_ptr->gravityx = (double) buf / ufact;
 
    buf = ((int16_t)data[3] << 8) | data[2];
-   if(verbose == 1) printf("Debug: Gravity Vector M: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
+   if(bno_debug == 1) printf("Debug: Gravity Vector M: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
    bnod_ptr->gravityy = (double) buf / ufact;
 
    buf = ((int16_t)data[5] << 8) | data[4];
-   if(verbose == 1) printf("Debug: Gravity Vector P: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
+   if(bno_debug == 1) printf("Debug: Gravity Vector P: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
    bnod_ptr->gravityz = (double) buf / ufact;
    return(0);
 }
 
 /* ------------------------------------------------------------ *
- *  get_lin() - read linear acceleration into the global struct *
+ *  bno_get_lin() - read linear acceleration into the struct    *
  * ------------------------------------------------------------ */
-int get_lin(struct bnolin *bnod_ptr) {
+int bno_get_lin(struct bnolin *bnod_ptr) {
    /* --------------------------------------------------------- *
     * Get the unit conversion: 1 m/s2 = 100 LSB, 1 mg = 1 LSB   *
     * --------------------------------------------------------- */
    char reg = BNO055_UNIT_SEL_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
    char unit_sel;
-   if(read(i2cfd, &unit_sel, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(&unit_sel, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
 
@@ -842,100 +957,267 @@ int get_lin(struct bnolin *bnod_ptr) {
     * Get the linear acceleration data                          *
     * --------------------------------------------------------- */
    reg = BNO055_LIN_ACC_DATA_X_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
-   if(verbose == 1) printf("Debug: I2C read 6 bytes starting at register 0x%02X\n", reg);
+   if(bno_debug == 1) printf("Debug: I2C read 6 bytes starting at register 0x%02X\n", reg);
 
    unsigned char data[6] = {0, 0, 0, 0, 0, 0};
-   if(read(i2cfd, data, 6) != 6) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(data, 6) != 6) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
 
    int16_t buf = ((int16_t)data[1] << 8) | data[0];
-   if(verbose == 1) printf("Debug: Linear Acceleration H: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
+   if(bno_debug == 1) printf("Debug: Linear Acceleration H: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
    bnod_ptr->linacc_x = (double) buf / ufact;
 
    buf = ((int16_t)data[3] << 8) | data[2];
-   if(verbose == 1) printf("Debug: Linear Acceleration M: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
+   if(bno_debug == 1) printf("Debug: Linear Acceleration M: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
    bnod_ptr->linacc_y = (double) buf / ufact;
 
    buf = ((int16_t)data[5] << 8) | data[4];
-   if(verbose == 1) printf("Debug: Linear Acceleration P: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
+   if(bno_debug == 1) printf("Debug: Linear Acceleration P: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
    bnod_ptr->linacc_z = (double) buf / ufact;
    return(0);
 }
 
 /* ------------------------------------------------------------ *
- * set_mode() - set the sensor operational mode register 0x3D   *
+ * bno_get_unit() returns the SI unit selection from reg 0x3B   *
+ * ------------------------------------------------------------ */
+int bno_get_unit(void) {
+   char reg = BNO055_UNIT_SEL_ADDR;
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
+      return(-1);
+   }
+
+   unsigned char data = 0;
+   if(bno_bus_read(&data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
+      return(-1);
+   }
+
+   if(bno_debug == 1) printf("Debug: UnitDefinition: [0x%02X]\n", data);
+   return(data);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_raw_chan() returns the index of the first raw value of   *
+ * the channel ch (a BNO_CH_* bit), its value count in *count.  *
+ * ------------------------------------------------------------ */
+int bno_raw_chan(int ch, int *count) {
+   char reg;
+   *count = 3;
+   switch(ch) {
+      case BNO_CH_ACC: reg = BNO055_ACC_DATA_X_LSB_ADDR; break;
+      case BNO_CH_MAG: reg = BNO055_MAG_DATA_X_LSB_ADDR; break;
+      case BNO_CH_GYR: reg = BNO055_GYRO_DATA_X_LSB_ADDR; break;
+      case BNO_CH_EUL: reg = BNO055_EULER_H_LSB_ADDR; break;
+      case BNO_CH_QUA: reg = BNO055_QUATERNION_DATA_W_LSB_ADDR; *count = 4; break;
+      case BNO_CH_LIN: reg = BNO055_LIN_ACC_DATA_X_LSB_ADDR; break;
+      case BNO_CH_GRA: reg = BNO055_GRAVITY_DATA_X_LSB_ADDR; break;
+      default: *count = 0; return(-1);
+   }
+   return((reg - BNO055_ACC_DATA_X_LSB_ADDR) / 2);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_get_raw() reads the int16 register values of all         *
+ * channels in mask with a single burst, spanning from the      *
+ * lowest to the highest requested channel. No scaling is       *
+ * applied, the values are identical to the INT16 that          *
+ * bno_get_acc(), bno_get_qua() etc see. The transaction is     *
+ * bracketed by CLOCK_MONOTONIC stamps t0/t1.                   *
+ * With BNO_RAW_CALIB in mask, the same burst continues up to   *
+ * CALIB_STAT 0x35. With BNO_RAW_STATUS, a second burst reads   *
+ * SYS_STATUS 0x39 to OPR_MODE 0x3D. INT_STA 0x37 is left out,  *
+ * a read clears the pending interrupts.                        *
+ * ------------------------------------------------------------ */
+int bno_get_raw(struct bnoraw *raw, int mask) {
+   int first = BNO_RAW_COUNT, last = 0, i, n, idx;
+
+   for(i = 0; i < BNO_CH_COUNT; i++) {
+      if(! (mask & (1 << i))) continue;
+      idx = bno_raw_chan(1 << i, &n);
+      if(idx < first) first = idx;
+      if(idx + n > last) last = idx + n;
+   }
+   if(first >= last) return(-1);
+
+   struct timespec mono;
+   clock_gettime(CLOCK_MONOTONIC, &mono);
+   raw->t0 = (int64_t) mono.tv_sec * 1000000000 + mono.tv_nsec;
+
+   char reg = BNO055_ACC_DATA_X_LSB_ADDR + 2 * first;
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
+      return(-1);
+   }
+
+   int len = 2 * (last - first);
+   if(mask & BNO_RAW_CALIB) len = BNO055_CALIB_STAT_ADDR + 1 - reg;
+   if(bno_debug == 1) printf("Debug: I2C read %d bytes starting at register 0x%02X\n", len, reg);
+
+   unsigned char data[BNO055_OPR_MODE_ADDR + 1 - BNO055_ACC_DATA_X_LSB_ADDR] = {0};
+   if(bno_bus_read(data, len) != len) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
+      return(-1);
+   }
+   if(mask & BNO_RAW_STATUS) {
+      char sreg = BNO055_SYS_STAT_ADDR;
+      int slen = BNO055_OPR_MODE_ADDR + 1 - sreg;
+      if(bno_bus_write(&sreg, 1) != 1) {
+         bno_error("I2C write failure for register 0x%02X\n", sreg);
+         return(-1);
+      }
+      if(bno_debug == 1) printf("Debug: I2C read %d bytes starting at register 0x%02X\n", slen, sreg);
+      if(bno_bus_read(data + (sreg - reg), slen) != slen) {
+         bno_error("I2C read failure for register data 0x%02X\n", sreg);
+         return(-1);
+      }
+   }
+   clock_gettime(CLOCK_MONOTONIC, &mono);
+   clock_gettime(CLOCK_REALTIME, &raw->ts);
+   raw->t1 = (int64_t) mono.tv_sec * 1000000000 + mono.tv_nsec;
+
+   for(i = 0; i < last - first; i++)
+      raw->val[first + i] = ((int16_t)data[2*i+1] << 8) | data[2*i];
+   raw->mask = mask & BNO_CH_ALL;
+   if(mask & BNO_RAW_CALIB) raw->calstat = data[BNO055_CALIB_STAT_ADDR - reg];
+   if(mask & BNO_RAW_STATUS) {
+      raw->sysstat = data[BNO055_SYS_STAT_ADDR - reg];
+      raw->syserr  = data[BNO055_SYS_ERR_ADDR - reg];
+      raw->oprmode = data[BNO055_OPR_MODE_ADDR - reg] & 0x0F;
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_raw_to_sample() converts raw values into the measurement *
+ * units, using the same factors as the get_xxx() functions.    *
+ * unitsel is the register 0x3B content from bno_get_unit().    *
+ * ------------------------------------------------------------ */
+void bno_raw_to_sample(struct bnoraw *raw, struct bnosample *s, int unitsel) {
+   int16_t *v = raw->val;
+   double ufact = ((unitsel >> 0) & 0x01) ? 1.0 : 100.0;
+
+   s->ts = raw->ts;
+   s->mask = raw->mask;
+   s->acc.adata_x  = (double) v[0];
+   s->acc.adata_y  = (double) v[1];
+   s->acc.adata_z  = (double) v[2];
+   s->mag.mdata_x  = (double) v[3] / 1.6;
+   s->mag.mdata_y  = (double) v[4] / 1.6;
+   s->mag.mdata_z  = (double) v[5] / 1.6;
+   s->gyr.gdata_x  = (double) v[6] / 16.0;
+   s->gyr.gdata_y  = (double) v[7] / 16.0;
+   s->gyr.gdata_z  = (double) v[8] / 16.0;
+   s->eul.eul_head = (double) v[9] / 16.0;
+   s->eul.eul_roll = (double) v[10] / 16.0;
+   s->eul.eul_pitc = (double) v[11] / 16.0;
+   s->qua.quater_w = (double) v[12] / 16384.0;
+   s->qua.quater_x = (double) v[13] / 16384.0;
+   s->qua.quater_y = (double) v[14] / 16384.0;
+   s->qua.quater_z = (double) v[15] / 16384.0;
+   s->lin.linacc_x = (double) v[16] / ufact;
+   s->lin.linacc_y = (double) v[17] / ufact;
+   s->lin.linacc_z = (double) v[18] / ufact;
+   s->gra.gravityx = (double) v[19] / ufact;
+   s->gra.gravityy = (double) v[20] / ufact;
+   s->gra.gravityz = (double) v[21] / ufact;
+   if(raw->mask & BNO_CH_TMP) s->temp = ((unitsel >> 4) & 0x01) ? raw->temp * 2.0 : raw->temp;  // 1 LSB = 1 C or 2 F
+}
+
+/* ------------------------------------------------------------ *
+ * bno_get_modecode() translates an operations mode name, e.g.  *
+ * ndof into the register value, or -1 for an unknown name.     *
+ * bno_get_pwrcode() does the same for the power mode names.    *
+ * ------------------------------------------------------------ */
+int bno_get_modecode(const char *name) {
+   static const char *names[] = { "config", "acconly", "magonly", "gyronly",
+      "accmag", "accgyro", "maggyro", "amg", "imu", "compass", "m4g", "ndof", "ndof_fmc" };
+   int i;
+   for(i = 0; i <= BNO_MODE_NDOF_FMC; i++) if(strcmp(name, names[i]) == 0) return(i);
+   return(-1);
+}
+
+int bno_get_pwrcode(const char *name) {
+   static const char *names[] = { "normal", "low", "suspend" };
+   int i;
+   for(i = 0; i <= BNO_PWR_SUSPEND; i++) if(strcmp(name, names[i]) == 0) return(i);
+   return(-1);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_set_mode() - set the sensor operational mode reg 0x3D    *
  * The modes cannot be switched over directly, first it needs   *
  * to be set to "config" mode before switching to the new mode. *
  * ------------------------------------------------------------ */
-int set_mode(opmode_t newmode) {
+int bno_set_mode(bno_opmode_t newmode) {
    char data[2] = {0};
    data[0] = BNO055_OPR_MODE_ADDR;
-   opmode_t oldmode = get_mode();
+   bno_opmode_t oldmode = bno_get_mode();
 
    if(oldmode == newmode) return(0); // if new mode is the same
    else if(oldmode > 0 && newmode > 0) {  // switch to "config" first
       data[1] = 0x0;
-      if(verbose == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-      if(write(i2cfd, data, 2) != 2) {
-         printf("Error: I2C write failure for register 0x%02X\n", data[0]);
+      if(bno_debug == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
+      if(bno_bus_write(data, 2) != 2) {
+         bno_error("I2C write failure for register 0x%02X\n", data[0]);
          return(-1);
       }
       /* --------------------------------------------------------- *
        * switch time: any->config needs 7ms + small buffer = 10ms  *
        * --------------------------------------------------------- */
-      usleep(10 * 1000);
+      bno_bus_sleep(10 * 1000, __func__);
    }
 
    data[1] = newmode;
-   if(verbose == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-   if(write(i2cfd, data, 2) != 2) {
-      printf("Error: I2C write failure for register 0x%02X\n", data[0]);
+   if(bno_debug == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
+   if(bno_bus_write(data, 2) != 2) {
+      bno_error("I2C write failure for register 0x%02X\n", data[0]);
       return(-1);
    }
    /* --------------------------------------------------------- *
     * switch time: config->any needs 19ms + small buffer = 25ms *
     * --------------------------------------------------------- */
-   usleep(25 * 1000);
+   bno_bus_sleep(25 * 1000, __func__);
 
-   if(get_mode() == newmode) return(0);
+   if(bno_get_mode() == newmode) return(0);
    else return(-1);
 }
 
 /* ------------------------------------------------------------ *
- * get_mode() - returns sensor operational mode register 0x3D   *
+ * bno_get_mode() - returns sensor operational mode reg 0x3D    *
  * Reads 1 byte from Operations Mode register 0x3d, and uses    *
  * only the lowest 4 bit. Bits 4-7 are unused, stripped off     *
  * ------------------------------------------------------------ */
-int get_mode() {
+int bno_get_mode(void) {
    int reg = BNO055_OPR_MODE_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    unsigned int data = 0;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(&data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
 
-   if(verbose == 1) printf("Debug: Operation Mode: [0x%02X]\n", data & 0x0F);
+   if(bno_debug == 1) printf("Debug: Operation Mode: [0x%02X]\n", data & 0x0F);
 
    return(data & 0x0F);  // only return the lowest 4 bits
 }
 
 /* ------------------------------------------------------------ *
- * print_mode() - prints sensor operational mode string from    *
+ * bno_print_mode() - prints sensor operational mode string from*
  * sensor operational mode numeric value.                       *
  * ------------------------------------------------------------ */
-int print_mode(int mode) {
+int bno_print_mode(int mode) {
    if(mode < 0 || mode > 12) return(-1);
    
    switch(mode) {
@@ -983,17 +1265,17 @@ int print_mode(int mode) {
 }
 
 /* ------------------------------------------------------------ *
- * set_power() - set the sensor power mode in register 0x3E.    *
+ * bno_set_power() - set the sensor power mode in register 0x3E.*
  * The power modes cannot be switched over directly, first the  *
  * ops mode needs to be "config"  to write the new power mode.  *
  * ------------------------------------------------------------ */
-int set_power(power_t pwrmode) {
+int bno_set_power(bno_power_t pwrmode) {
    char data[2] = {0};
 
 /* ------------------------------------------------------------ *
  * Check what operational mode we are in                        *
  * ------------------------------------------------------------ */
-   opmode_t oldmode = get_mode();
+   bno_opmode_t oldmode = bno_get_mode();
 
 /* ------------------------------------------------------------ *
  * If ops mode wasn't config, switch to "CONFIG" mode first     *
@@ -1001,12 +1283,12 @@ int set_power(power_t pwrmode) {
    if(oldmode > 0) {
       data[0] = BNO055_OPR_MODE_ADDR;
       data[1] = 0x0;
-      if(verbose == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-      if(write(i2cfd, data, 2) != 2) {
-         printf("Error: I2C write failure for register 0x%02X\n", data[0]);
+      if(bno_debug == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
+      if(bno_bus_write(data, 2) != 2) {
+         bno_error("I2C write failure for register 0x%02X\n", data[0]);
          return(-1);
       }
-      usleep(30 * 1000);
+      bno_bus_sleep(30 * 1000, __func__);
    }  // now we are in config mode
 
 /* ------------------------------------------------------------ *
@@ -1014,12 +1296,12 @@ int set_power(power_t pwrmode) {
  * ------------------------------------------------------------ */
    data[0] = BNO055_PWR_MODE_ADDR;
    data[1] = pwrmode;
-   if(verbose == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-   if(write(i2cfd, data, 2) != 2) {
-      printf("Error: I2C write failure for register 0x%02X\n", data[0]);
+   if(bno_debug == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
+   if(bno_bus_write(data, 2) != 2) {
+      bno_error("I2C write failure for register 0x%02X\n", data[0]);
       return(-1);
    }
-   usleep(30 * 1000);
+   bno_bus_sleep(30 * 1000, __func__);
 
 /* ------------------------------------------------------------ *
  * If ops mode wasn't config, switch back to original ops mode  *
@@ -1027,45 +1309,45 @@ int set_power(power_t pwrmode) {
    if(oldmode > 0) {
       data[0] = BNO055_OPR_MODE_ADDR;
       data[1] = oldmode;
-      if(verbose == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-      if(write(i2cfd, data, 2) != 2) {
-         printf("Error: I2C write failure for register 0x%02X\n", data[0]);
+      if(bno_debug == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
+      if(bno_bus_write(data, 2) != 2) {
+         bno_error("I2C write failure for register 0x%02X\n", data[0]);
          return(-1);
       }
-      usleep(30 * 1000);
+      bno_bus_sleep(30 * 1000, __func__);
    }  // now the previous mode is back
 
-   if(get_power() == pwrmode) return(0);
+   if(bno_get_power() == pwrmode) return(0);
    else return(-1);
 }
 
 /* ------------------------------------------------------------ *
- * get_power() returns the sensor power mode from register 0x3e *
+ * bno_get_power() returns the sensor power mode from reg 0x3e  *
  * Only the lowest 2 bit are used, ignore the unused bits 2-7.  *
  * ------------------------------------------------------------ */
-int get_power() {
+int bno_get_power(void) {
    int reg = BNO055_PWR_MODE_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    unsigned int data = 0;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(&data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
 
-   if(verbose == 1) printf("Debug:     Power Mode: [0x%02X] 2bit [0x%02X]\n", data, data & 0x03);
+   if(bno_debug == 1) printf("Debug:     Power Mode: [0x%02X] 2bit [0x%02X]\n", data, data & 0x03);
 
    return(data & 0x03);  // only return the lowest 2 bits
 }
 
 /* ------------------------------------------------------------ *
- * print_power() - prints the sensor power mode string from the *
- * sensors power mode numeric value.                            *
+ * bno_print_power() - prints the sensor power mode string from *
+ * the sensors power mode numeric value.                        *
  * ------------------------------------------------------------ */
-int print_power(int mode) {
+int bno_print_power(int mode) {
    if(mode < 0 || mode > 2) return(-1);
 
    switch(mode) {
@@ -1083,31 +1365,31 @@ int print_power(int mode) {
 }
 
 /* ------------------------------------------------------------ *
- * get_sstat() returns the sensor sys status from register 0x39 *
+ * bno_get_sstat() returns the sensor sys status from reg 0x39  *
  * ------------------------------------------------------------ */
-int get_sstat() {
+int bno_get_sstat(void) {
    int reg = BNO055_SYS_STAT_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    unsigned int data = 0;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(&data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
 
-   if(verbose == 1) printf("Debug:  System Status: [0x%02X]\n", data);
+   if(bno_debug == 1) printf("Debug:  System Status: [0x%02X]\n", data);
 
    return(data);
 }
 
 /* ------------------------------------------------------------ *
- * print_sstat() - prints the sensor system status string from  *
- * the numeric value located in the sys_stat register 0x39      *
+ * bno_print_sstat() - prints the sensor system status string   *
+ * from the numeric value located in the sys_stat register 0x39 *
  * ------------------------------------------------------------ */
-int print_sstat(int stat_code) {
+int bno_print_sstat(int stat_code) {
    if(stat_code < 0 || stat_code > 6) return(-1);
 
    switch(stat_code) {
@@ -1137,41 +1419,41 @@ int print_sstat(int stat_code) {
 }
 
 /* ------------------------------------------------------------ *
- * get_remap() returns axis remap data from registers 0x41 0x42 *
+ * bno_get_remap() returns axis remap data from regs 0x41 0x42  *
  * ------------------------------------------------------------ */
-int get_remap(char mode) {
+int bno_get_remap(char mode) {
    int reg;
 
    if(mode == 'c') reg = BNO055_AXIS_MAP_CONFIG_ADDR;
    else if(mode == 's') reg = BNO055_AXIS_MAP_SIGN_ADDR;
    else {
-      printf("Error: Unknown remap function mode %c.\n", mode);
-      exit(-1);
+      bno_error("Unknown remap function mode %c.\n", mode);
+      return(-1);
    }
 
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
       return(-1);
    }
 
    unsigned int data = 0;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
+   if(bno_bus_read(&data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
       return(-1);
    }
 
-   if(verbose == 1) printf("Debug: Axis Remap '%c': [0x%02X]\n", mode, data);
+   if(bno_debug == 1) printf("Debug: Axis Remap '%c': [0x%02X]\n", mode, data);
 
    return(data);
 }
 
 /* ------------------------------------------------------------ *
- * print_remap_conf() - prints the sensor axis configuration.   *
+ * bno_print_remap_conf() - prints the sensor axis config.      *
  * the numeric values are located in register 0x41. Valid modes *
  * are: 
  * 0x24 (default), 0x21, 
  * ------------------------------------------------------------ */
-int print_remap_conf(int mode) {
+int bno_print_remap_conf(int mode) {
 
    if(mode != 0x24 && mode != 0x18 && mode != 0x09 && mode != 0x36) return(-1);
 
@@ -1193,10 +1475,10 @@ int print_remap_conf(int mode) {
 }
 
 /* ------------------------------------------------------------ *
- * print_remap_sign() - prints the sensor axis remapping +/-.   *
+ * bno_print_remap_sign() - prints the sensor axis remap +/-.   *
  * the numeric values are located in register 0x42.             *
  * ------------------------------------------------------------ */
-int print_remap_sign(int mode) {
+int bno_print_remap_sign(int mode) {
 
    if(mode < 0 || mode > 7) return(-1);
 
@@ -1230,122 +1512,186 @@ int print_remap_sign(int mode) {
 }
 
 /* ------------------------------------------------------------ *
- * set_page0() - Set page ID = 0 to set default register access *
+ * bno_set_page0() - Set page ID = 0 for default register access*
  * ------------------------------------------------------------ */
-int set_page0() {
+int bno_set_page0() {
    char data[2] = {0};
    data[0] = BNO055_PAGE_ID_ADDR;
    data[1] = 0x0;
-   if(verbose == 1) printf("Debug: write page-ID: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-   if(write(i2cfd, data, 2) != 2) {
-      printf("Error: I2C write failure for register 0x%02X\n", data[0]);
+   if(bno_debug == 1) printf("Debug: write page-ID: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
+   if(bno_bus_write(data, 2) != 2) {
+      bno_error("I2C write failure for register 0x%02X\n", data[0]);
       return(-1);
    }
    return(0);
 }
 
 /* ------------------------------------------------------------ *
- * set_page1() - Set page ID = 1 to switch the register access  *
+ * bno_set_page1() - Set page ID = 1 to switch register access  *
  * ------------------------------------------------------------ */
-int set_page1() {
+int bno_set_page1() {
    char data[2] = {0};
    data[0] = BNO055_PAGE_ID_ADDR;
    data[1] = 0x1;
-   if(verbose == 1) printf("Debug: write page-ID: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-   if(write(i2cfd, data, 2) != 2) {
-      printf("Error: I2C write failure for register 0x%02X\n", data[0]);
+   if(bno_debug == 1) printf("Debug: write page-ID: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
+   if(bno_bus_write(data, 2) != 2) {
+      bno_error("I2C write failure for register 0x%02X\n", data[0]);
       return(-1);
    }
    return(0);
 }
 
 /* ------------------------------------------------------------ *
- * get_clksrc() - return setting for internal/external clock    *
+ * bno_get_clksrc() - return setting for internal/external clock*
  * ------------------------------------------------------------ */
-int get_clksrc() {
+int bno_get_clksrc(void) {
    char reg = BNO055_SYS_TRIGGER_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      set_page0();
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
+      bno_set_page0();
       return(-1);
    }
 
    char data;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      set_page0();
+   if(bno_bus_read(&data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
+      bno_set_page0();
       return(-1);
    }
 
-   if(verbose == 1) printf("Debug: CLK_SEL bit-7 in register %d: [%d]\n", reg, (data & 0b10000000) >> 7);
+   if(bno_debug == 1) printf("Debug: CLK_SEL bit-7 in register %d: [%d]\n", reg, (data & 0b10000000) >> 7);
    return (data & 0b10000000) >> 7; // system calibration status
 }
 
 /* ------------------------------------------------------------ *
- * print_clksrc() - print setting for internal/external clock   *
+ * bno_get_clkstat() - return SYS_CLK_STAT 0x38 bit-0, 0 means  *
+ * the clock source is free to be configured, 1 = it is busy.   *
+ * ------------------------------------------------------------ */
+int bno_get_clkstat(void) {
+   char reg = BNO055_SYS_CLK_STAT_ADDR;
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
+      return(-1);
+   }
+
+   char data;
+   if(bno_bus_read(&data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
+      return(-1);
+   }
+
+   if(bno_debug == 1) printf("Debug: ST_MAIN_CLK bit-0 in register %d: [%d]\n", reg, data & 0x01);
+   return(data & 0x01);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_set_clksrc() - select the external 32kHz crystal (1) or  *
+ * the internal oscillator (0). CLK_SEL in SYS_TRIGGER can only *
+ * change in CONFIG mode, and when SYS_CLK_STAT reports ready.  *
+ * The previous operations mode is restored after verification. *
+ * ------------------------------------------------------------ */
+int bno_set_clksrc(int ext) {
+   char data[2] = {0};
+   int i, res = 0;
+
+   int oldmode = bno_get_mode();
+   if(oldmode < 0) return(-1);
+   if(oldmode > 0 && bno_set_mode(BNO_MODE_CONFIG) != 0) return(-1);
+
+   for(i = 0; i < 50 && bno_get_clkstat() != 0; i++) bno_bus_sleep(10 * 1000, __func__);
+   if(i == 50) {
+      bno_error("clock source not ready for configuration.\n");
+      res = -1;
+   }
+   else {
+      data[0] = BNO055_SYS_TRIGGER_ADDR;
+      data[1] = ext ? 0b10000000 : 0x0;
+      if(bno_debug == 1) printf("Debug: Write clk_sel: [0x%02X] to register [0x%02X]\n", (unsigned char) data[1], data[0]);
+      if(bno_bus_write(data, 2) != 2) {
+         bno_error("I2C write failure for register 0x%02X\n", data[0]);
+         res = -1;
+      }
+      bno_bus_sleep(10 * 1000, __func__);
+
+      /* --------------------------------------------------------- *
+       * Wait for the clock switch to finish, and read it back     *
+       * --------------------------------------------------------- */
+      for(i = 0; res == 0 && i < 50 && bno_get_clkstat() != 0; i++) bno_bus_sleep(10 * 1000, __func__);
+      if(res == 0 && bno_get_clksrc() != (ext ? 1 : 0)) {
+         bno_error("clock source did not change to %s.\n", ext ? "external" : "internal");
+         res = -1;
+      }
+   }
+
+   if(oldmode > 0 && bno_set_mode(oldmode) != 0) return(-1);
+   return(res);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_print_clksrc() - print the int/ext clock source setting  *
  * ------------------------------------------------------------ */
-void print_clksrc() {
-   int src = get_clksrc();
+void bno_print_clksrc() {
+   int src = bno_get_clksrc();
    if(src == 0) printf("Internal Clock (default)\n");
    if(src == 1) printf("External Clock\n");
    if(src == -1) printf("Clock Reading error\n");
 }
 
 /* ------------------------------------------------------------ *
- * get_acc_conf() read accelerometer config into global struct  *
+ * bno_get_acc_conf() read accelerometer config into the struct *
  * Requires switching register page 0->1 and back after reading *
  * ------------------------------------------------------------ */
-int get_acc_conf(struct bnoaconf *bnoc_ptr) {
+int bno_get_acc_conf(struct bnoaconf *bnoc_ptr) {
 
-   set_page1();
+   bno_set_page1();
    char reg = BNO055_ACC_CONFIG_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      set_page0();
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
+      bno_set_page0();
       return(-1);
    }
 
    char data;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      set_page0();
+   if(bno_bus_read(&data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
+      bno_set_page0();
       return(-1);
    }
 
    bnoc_ptr->range   = (data & 0b00000011) >> 2; // accel range
-   if(verbose == 1) printf("Debug:       accelerometer range: [%d]\n", bnoc_ptr->pwrmode);
+   if(bno_debug == 1) printf("Debug:       accelerometer range: [%d]\n", bnoc_ptr->pwrmode);
    bnoc_ptr->bandwth = (data & 0b00011100) >> 4; // accel bandwidth
-   if(verbose == 1) printf("Debug:   accelerometer bandwidth: [%d]\n", bnoc_ptr->bandwth);
+   if(bno_debug == 1) printf("Debug:   accelerometer bandwidth: [%d]\n", bnoc_ptr->bandwth);
    bnoc_ptr->pwrmode = (data & 0b11100000) >> 6; // accel power mode
-   if(verbose == 1) printf("Debug:  accelerometer power mode: [%d]\n", bnoc_ptr->pwrmode);
+   if(bno_debug == 1) printf("Debug:  accelerometer power mode: [%d]\n", bnoc_ptr->pwrmode);
 
    reg = BNO055_ACC_SLEEP_CONFIG_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      set_page0();
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
+      bno_set_page0();
       return(-1);
    }
 
    data = 0;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      set_page0();
+   if(bno_bus_read(&data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
+      bno_set_page0();
       return(-1);
    }
 
    bnoc_ptr->slpmode = (data & 0b00000011) >> 2; // accel sleep mode
-   if(verbose == 1) printf("Debug:  accelerometer sleep mode: [%d]\n", bnoc_ptr->slpmode);
+   if(bno_debug == 1) printf("Debug:  accelerometer sleep mode: [%d]\n", bnoc_ptr->slpmode);
    bnoc_ptr->slpdur = (data & 0b00011100) >> 4; // accel sleep duration
-   if(verbose == 1) printf("Debug:   accelerometer sleep dur: [%d]\n", bnoc_ptr->slpdur);
+   if(bno_debug == 1) printf("Debug:   accelerometer sleep dur: [%d]\n", bnoc_ptr->slpdur);
 
-   set_page0();
+   bno_set_page0();
    return(0);
 }
 
 /* ----------------------------------------------------------- *
- *  print_acc_conf() - print accelerometer configuration       *
+ *  bno_print_acc_conf() - print accelerometer configuration   *
  * ----------------------------------------------------------- */
-void print_acc_conf(struct bnoaconf *bnoc_ptr) {
+void bno_print_acc_conf(struct bnoaconf *bnoc_ptr) {
    printf("Accelerometer  Power = ");
    switch(bnoc_ptr->pwrmode) {
       case 0:
@@ -1452,3 +1798,165 @@ void print_acc_conf(struct bnoaconf *bnoc_ptr) {
          break;
    }
 }
+
+/* ------------------------------------------------------------ *
+ * get_int_regs() burst reads the page-1 registers 0x0F..0x1F   *
+ * ------------------------------------------------------------ */
+static int get_int_regs(unsigned char *data) {
+   char reg = BNO055_INT_MSK_ADDR;
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
+      return(-1);
+   }
+   if(bno_bus_read(data, BNO055_INT_REGCOUNT) != BNO055_INT_REGCOUNT) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
+      return(-1);
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_get_int_conf() reads the interrupt config registers      *
+ * Requires switching register page 0->1 and back after reading *
+ * ------------------------------------------------------------ */
+int bno_get_int_conf(struct bnoint *bnoi_ptr) {
+   unsigned char data[BNO055_INT_REGCOUNT] = {0};
+   unsigned char *r = data - BNO055_INT_MSK_ADDR; // index by reg
+
+   bno_set_page1();
+   if(get_int_regs(data) != 0) {
+      bno_set_page0();
+      return(-1);
+   }
+   bno_set_page0();
+
+   bnoi_ptr->mask      = r[BNO055_INT_MSK_ADDR];
+   bnoi_ptr->enable    = r[BNO055_INT_EN_ADDR];
+   bnoi_ptr->am_thres  = r[BNO055_ACC_AM_THRES_ADDR];
+   bnoi_ptr->am_dur    = r[BNO055_ACC_INT_SET_ADDR] & 0b00000011;
+   bnoi_ptr->hg_dur    = r[BNO055_ACC_HG_DURATION_ADDR];
+   bnoi_ptr->hg_thres  = r[BNO055_ACC_HG_THRES_ADDR];
+   bnoi_ptr->nm_thres  = r[BNO055_ACC_NM_THRES_ADDR];
+   bnoi_ptr->nm_dur    = (r[BNO055_ACC_NM_SET_ADDR] & 0b01111110) >> 1;
+   bnoi_ptr->hr_thres  = r[BNO055_GYR_HR_X_SET_ADDR] & 0b00011111;
+   bnoi_ptr->hr_dur    = r[BNO055_GYR_DUR_X_ADDR];
+   bnoi_ptr->gam_thres = r[BNO055_GYR_AM_THRES_ADDR] & 0b01111111;
+   if(bno_debug == 1) printf("Debug: INT_EN: [0x%02X] INT_MSK: [0x%02X]\n",
+                           bnoi_ptr->enable, bnoi_ptr->mask);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_set_int_conf() writes the interrupt configuration. Page-1*
+ * registers can only be written in CONFIG mode, the current    *
+ * mode is restored afterwards. All axes are enabled for each   *
+ * detector, no-motion (not slow-motion) is selected on 0x16.   *
+ * ------------------------------------------------------------ */
+int bno_set_int_conf(struct bnoint *bnoi_ptr) {
+   unsigned char data[BNO055_INT_REGCOUNT + 1] = {0};
+   unsigned char *r = data + 1 - BNO055_INT_MSK_ADDR; // index by reg
+   int mode = bno_get_mode();
+   int res = 0;
+
+   if(mode < 0 || bno_set_mode(BNO_MODE_CONFIG) != 0) return(-1);
+   bno_set_page1();
+   if(get_int_regs(data + 1) != 0) res = -1;
+   else {
+      r[BNO055_INT_MSK_ADDR]          = bnoi_ptr->mask;
+      r[BNO055_INT_EN_ADDR]           = bnoi_ptr->enable;
+      r[BNO055_ACC_AM_THRES_ADDR]     = bnoi_ptr->am_thres;
+      r[BNO055_ACC_INT_SET_ADDR]      = 0b11111100 | (bnoi_ptr->am_dur & 0b00000011);
+      r[BNO055_ACC_HG_DURATION_ADDR]  = bnoi_ptr->hg_dur;
+      r[BNO055_ACC_HG_THRES_ADDR]     = bnoi_ptr->hg_thres;
+      r[BNO055_ACC_NM_THRES_ADDR]     = bnoi_ptr->nm_thres;
+      r[BNO055_ACC_NM_SET_ADDR]       = ((bnoi_ptr->nm_dur & 0b00111111) << 1) | 0x01;
+      r[BNO055_GYR_INT_SET_ADDR]     |= 0b00111111;
+      r[BNO055_GYR_HR_X_SET_ADDR]     = (r[BNO055_GYR_HR_X_SET_ADDR] & 0b01100000)
+                                      | (bnoi_ptr->hr_thres & 0b00011111);
+      r[BNO055_GYR_HR_Y_SET_ADDR]     = r[BNO055_GYR_HR_X_SET_ADDR];
+      r[BNO055_GYR_HR_Z_SET_ADDR]     = r[BNO055_GYR_HR_X_SET_ADDR];
+      r[BNO055_GYR_DUR_X_ADDR]        = bnoi_ptr->hr_dur;
+      r[BNO055_GYR_DUR_Y_ADDR]        = bnoi_ptr->hr_dur;
+      r[BNO055_GYR_DUR_Z_ADDR]        = bnoi_ptr->hr_dur;
+      r[BNO055_GYR_AM_THRES_ADDR]     = bnoi_ptr->gam_thres & 0b01111111;
+
+      data[0] = BNO055_INT_MSK_ADDR;
+      if(bno_debug == 1) printf("Debug: write INT_EN: [0x%02X] INT_MSK: [0x%02X]\n",
+                              bnoi_ptr->enable, bnoi_ptr->mask);
+      if(bno_bus_write(data, sizeof(data)) != sizeof(data)) {
+         bno_error("I2C write failure for register 0x%02X\n", data[0]);
+         res = -1;
+      }
+   }
+   bno_set_page0();
+   if(bno_set_mode(mode) != 0) return(-1);
+   return(res);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_print_int_conf() - print the interrupt configuration     *
+ * ------------------------------------------------------------ */
+void bno_print_int_conf(struct bnoint *bnoi_ptr) {
+   printf("Interrupt   Enabled = "); bno_print_intstat(bnoi_ptr->enable, stdout);
+   printf("Interrupt   INT pin = "); bno_print_intstat(bnoi_ptr->mask, stdout);
+   printf("Acc AnyMotion Thres = %d (x 3.91mg @2G range), %d samples\n",
+          bnoi_ptr->am_thres, bnoi_ptr->am_dur + 1);
+   printf("Acc  NoMotion Thres = %d (x 3.91mg @2G range), duration code %d\n",
+          bnoi_ptr->nm_thres, bnoi_ptr->nm_dur);
+   printf("Acc    High-G Thres = %d (x 7.81mg @2G range), %dms\n",
+          bnoi_ptr->hg_thres, (bnoi_ptr->hg_dur + 1) * 2);
+   printf("Gyr AnyMotion Thres = %d (x 1dps @2000dps range)\n", bnoi_ptr->gam_thres);
+   printf("Gyr  HighRate Thres = %d (x 62.5dps @2000dps range), %.1fms\n",
+          bnoi_ptr->hr_thres, (bnoi_ptr->hr_dur + 1) * 2.5);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_print_intstat() - print the interrupt source bits by name*
+ * ------------------------------------------------------------ */
+void bno_print_intstat(int stat, FILE *fp) {
+   if(stat & BNO_INT_ACC_AM) fprintf(fp, "acc_am ");
+   if(stat & BNO_INT_ACC_NM) fprintf(fp, "acc_nm ");
+   if(stat & BNO_INT_ACC_HG) fprintf(fp, "acc_hg ");
+   if(stat & BNO_INT_GYR_AM) fprintf(fp, "gyr_am ");
+   if(stat & BNO_INT_GYR_HR) fprintf(fp, "gyr_hr ");
+   if(stat == 0) fprintf(fp, "none");
+   fprintf(fp, "\n");
+}
+
+/* ------------------------------------------------------------ *
+ * bno_get_intstat() returns the interrupt status register 0x37.*
+ * The sensor clears the status bits when they are read.        *
+ * ------------------------------------------------------------ */
+int bno_get_intstat(void) {
+   char reg = BNO055_INTR_STAT_ADDR;
+   if(bno_bus_write(&reg, 1) != 1) {
+      bno_error("I2C write failure for register 0x%02X\n", reg);
+      return(-1);
+   }
+
+   unsigned char data = 0;
+   if(bno_bus_read(&data, 1) != 1) {
+      bno_error("I2C read failure for register data 0x%02X\n", reg);
+      return(-1);
+   }
+
+   if(bno_debug == 1) printf("Debug: INT_STA: [0x%02X]\n", data);
+   return(data);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_int_reset() sets RST_INT in SYS_TRIGGER 0x3F to release  *
+ * the INT pin, keeping the clock source selection bit as it is.*
+ * ------------------------------------------------------------ */
+int bno_int_reset(void) {
+   char data[2] = {0};
+   data[0] = BNO055_SYS_TRIGGER_ADDR;
+   int clk = bno_get_clksrc();
+   if(clk < 0) return(-1);
+   data[1] = (clk << 7) | BNO_SYS_RST_INT;
+   if(bno_bus_write(data, 2) != 2) {
+      bno_error("I2C write failure for register 0x%02X\n", data[0]);
+      return(-1);
+   }
+   return(0);
+}
@@ -0,0 +1,113 @@
+/* ------------------------------------------------------------ *
+ * file:        irq_bno055.c                                    *
+ * purpose:     Wait for the BNO055 INT pin instead of polling. *
+ *              The pin is connected to a GPIO line, and edges  *
+ *              are requested through the gpiochip character    *
+ *              device. Between events the process sleeps in    *
+ *              poll(), without any I2C traffic or CPU load.    *
+ *              For tests, any eventfd stands in for the pin.   *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include "getbno055.h"
+
+/* ------------------------------------------------------------ *
+ * Event source: a gpio line request fd, or an attached eventfd *
+ * ------------------------------------------------------------ */
+static int irqfd = -1;
+static int irqgpio = 0;       // 1 = fd delivers gpio_v2_line_event
+
+/* ------------------------------------------------------------ *
+ * irq_open() requests rising edge events for "chip:line", e.g. *
+ * "/dev/gpiochip0:17" or "gpiochip0:17". The BNO055 INT pin is *
+ * active high, and stays high until bno_int_reset().           *
+ * ------------------------------------------------------------ */
+int irq_open(char *spec) {
+   struct gpio_v2_line_request req;
+   char chip[128];
+   char *sep = strrchr(spec, ':');
+
+   if(sep == NULL || sep - spec >= (int) sizeof(chip) - 8) {
+      printf("Error: invalid interrupt line [%s], use chip:line.\n", spec);
+      return(-1);
+   }
+   if(strchr(spec, '/') == NULL) strcpy(chip, "/dev/");
+   else chip[0] = '\0';
+   strncat(chip, spec, sep - spec);
+
+   int fd = open(chip, O_RDONLY | O_CLOEXEC);
+   if(fd < 0) {
+      printf("Error: Can't open GPIO chip %s.\n", chip);
+      return(-1);
+   }
+
+   memset(&req, 0, sizeof(req));
+   req.offsets[0] = atoi(sep + 1);
+   req.num_lines = 1;
+   req.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING;
+   strncpy(req.consumer, "getbno055", sizeof(req.consumer) - 1);
+   if(ioctl(fd, GPIO_V2_GET_LINE_IOCTL, &req) != 0) {
+      printf("Error: Can't request GPIO line %d edge events on %s.\n", req.offsets[0], chip);
+      close(fd);
+      return(-1);
+   }
+   close(fd);
+
+   irqfd = req.fd;
+   irqgpio = 1;
+   if(verbose == 1) printf("Debug: INT line [%s] offset [%d] fd [%d]\n", chip, req.offsets[0], irqfd);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * irq_attach() uses an eventfd as interrupt source, any write  *
+ * to it counts as one INT pin edge. Used to test without GPIO. *
+ * ------------------------------------------------------------ */
+void irq_attach(int fd) {
+   irqfd = fd;
+   irqgpio = 0;
+}
+
+/* ------------------------------------------------------------ *
+ * irq_wait() sleeps until the next edge, or timeout ms (-1 for *
+ * no timeout). Returns 1 on an event, 0 on timeout, and -1 on  *
+ * errors or if a signal interrupted the wait.                  *
+ * ------------------------------------------------------------ */
+int irq_wait(int timeout) {
+   struct pollfd pfd = { .fd = irqfd, .events = POLLIN };
+
+   if(irqfd < 0) return(-1);
+   int res = poll(&pfd, 1, timeout);
+   if(res <= 0) return(res);
+
+   /* -------------------------------------------------------- *
+    * Consume all queued edges, one sensor read serves them    *
+    * -------------------------------------------------------- */
+   if(irqgpio == 1) {
+      struct gpio_v2_line_event ev[16];
+      if(read(irqfd, ev, sizeof(ev)) < (ssize_t) sizeof(ev[0])) return(-1);
+   }
+   else {
+      uint64_t cnt;
+      if(read(irqfd, &cnt, sizeof(cnt)) != sizeof(cnt)) return(-1);
+   }
+   return(1);
+}
+
+/* ------------------------------------------------------------ *
+ * irq_close() releases the GPIO line                           *
+ * ------------------------------------------------------------ */
+void irq_close() {
+   if(irqfd >= 0 && irqgpio == 1) close(irqfd);
+   irqfd = -1;
+}
@@ -45,29 +45,15 @@ if [ "$silentmode" = false ] ; then
 fi
 
 # --------------------------------------------------------
-# Enable sensor configuration mode
+# Enable config mode, load the calibration data from the
+# previously saved file, and switch the sensor back into
+# its desired operations mode, in one batch
 # --------------------------------------------------------
-$BINPATH/getbno055 -a $I2CADDR -m config
-if [ "$silentmode" = false ] ; then
-   read -n1 -r -p "Changed mode to Config, Press any key to continue..." key
-fi
-
-# --------------------------------------------------------
-# Load the calibration data from a previously saved file
-# --------------------------------------------------------
-$BINPATH/getbno055 -a $I2CADDR -l $CALFILE
+$BINPATH/getbno055 -a $I2CADDR -e "mode config; load $CALFILE; mode ndof"
 if [ "$silentmode" = false ] ; then
    read -n1 -r -p "Loaded saved calibration offsets successfully. Press any key to continue..." key
 fi
 
-# --------------------------------------------------------
-# Switch sensor back into its desired operations mode
-# --------------------------------------------------------
-$BINPATH/getbno055 -a $I2CADDR -m ndof
-if [ "$silentmode" = false ] ; then
-   read -n1 -r -p "Switched back to operation mode. Press any key to continue..." key
-fi
-
 # --------------------------------------------------------
 # Show sensor settings information after calibration load
 # --------------------------------------------------------
@@ -0,0 +1,447 @@
+/* ------------------------------------------------------------ *
+ * file:        log_bno055.c                                    *
+ * purpose:     Compressed raw data log for long recordings.    *
+ *              Records hold the raw int16 register values, as  *
+ *              zigzag varint deltas to the previous record. A  *
+ *              block starts with a keyframe of absolute values *
+ *              and the file ends with a time index of blocks.  *
+ *              Encoding runs in a background thread, while the *
+ *              acquisition loop only copies into a queue. The  *
+ *              reader maps the file and finds any timestamp by *
+ *              binary search over the index in the footer.     *
+ *                                                              *
+ *              file   = header, block 1..n, index, trailer     *
+ *              header = "BNOL" ver hdrlen mask unitsel 0 recs  *
+ *              block  = "BLK0" payload-len record-count first- *
+ *                       timestamp, payload of varint records   *
+ *              record = dt-usec, value 1..n (all zigzag)       *
+ *              index  = "BIDX" count, per block: offset, first-*
+ *                       timestamp, record-count                *
+ *              trailer= index offset, last timestamp, "BEND"   *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "getbno055.h"
+
+#define LOG_QUEUESIZE  4096  // records buffered for the writer
+#define LOG_MAXREC     (10 + 3 * BNO_RAW_COUNT) // worst case varint record
+
+/* ------------------------------------------------------------ *
+ * Log writer state, the queue is shared with the writer thread *
+ * ------------------------------------------------------------ */
+static struct {
+   FILE *fp;
+   int nval;                         // values per record
+   int idx[BNO_RAW_COUNT];           // raw index of each value
+   pthread_t thread;
+   pthread_mutex_t lock;             // protects queue, head, tail, stop
+   pthread_cond_t cond;
+   struct bnoraw queue[LOG_QUEUESIZE];
+   unsigned long head;               // next record to queue
+   unsigned long tail;               // next record to encode
+   unsigned long dropped;            // records lost on a full queue
+   int stop;
+   unsigned char blk[BNO_LOG_BLOCKRECS * LOG_MAXREC];
+   int blen;                         // current block payload length
+   int brec;                         // records in the current block
+   int64_t first;                    // block start time in usec
+   int64_t prev;                     // previous record time in usec
+   struct bnoraw last;               // previous record values
+   uint64_t *idxoff;                 // block offsets for the index
+   int64_t  *idxtime;                // block start times in usec
+   uint32_t *idxrec;                 // block record counts
+   int nblk;
+   unsigned long records;
+} lw = { .lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+
+/* ------------------------------------------------------------ *
+ * Little-endian and zigzag varint helpers                      *
+ * ------------------------------------------------------------ */
+static unsigned char *put_le(unsigned char *p, uint64_t val, int n) {
+   int i;
+   for(i = 0; i < n; i++) p[i] = (val >> (8 * i)) & 0xFF;
+   return(p + n);
+}
+
+static uint64_t get_le(const unsigned char *p, int n) {
+   uint64_t val = 0;
+   int i;
+   for(i = n - 1; i >= 0; i--) val = (val << 8) | p[i];
+   return(val);
+}
+
+static int put_varint(unsigned char *p, int64_t sval) {
+   uint64_t val = ((uint64_t) sval << 1) ^ (uint64_t)(sval >> 63); // zigzag
+   int n = 0;
+   while(val >= 0x80) {
+      p[n++] = (val & 0x7F) | 0x80;
+      val >>= 7;
+   }
+   p[n++] = val;
+   return(n);
+}
+
+static int get_varint(const unsigned char *p, int *pos, int len, int64_t *sval) {
+   uint64_t val = 0;
+   int shift = 0;
+   while(*pos < len && shift < 64) {
+      unsigned char b = p[(*pos)++];
+      val |= (uint64_t)(b & 0x7F) << shift;
+      if(! (b & 0x80)) {
+         *sval = (int64_t)(val >> 1) ^ -(int64_t)(val & 1);
+         return(0);
+      }
+      shift += 7;
+   }
+   return(-1);
+}
+
+static int64_t ts_usec(struct timespec *ts) {
+   return((int64_t) ts->tv_sec * 1000000 + ts->tv_nsec / 1000);
+}
+
+/* ------------------------------------------------------------ *
+ * log_index() builds the list of raw value indexes for a mask  *
+ * ------------------------------------------------------------ */
+static int log_index(int mask, int *idx) {
+   int i, j, n, first, nval = 0;
+   for(i = 0; i < BNO_CH_COUNT; i++) {
+      if(! (mask & (1 << i))) continue;
+      first = bno_raw_chan(1 << i, &n);
+      for(j = 0; j < n; j++) idx[nval++] = first + j;
+   }
+   return(nval);
+}
+
+/* ------------------------------------------------------------ *
+ * log_flush() writes the current block, and records its offset *
+ * in the index. The block is always reset, so that the next    *
+ * records never run past the end of lw.blk.                    *
+ * ------------------------------------------------------------ */
+static void log_flush() {
+   unsigned char hdr[BNO_LOG_BLKHDRLEN];
+   if(lw.brec == 0) return;
+
+   void *p1 = realloc(lw.idxoff, (lw.nblk + 1) * sizeof(uint64_t));
+   if(p1 != NULL) lw.idxoff = p1;
+   void *p2 = realloc(lw.idxtime, (lw.nblk + 1) * sizeof(int64_t));
+   if(p2 != NULL) lw.idxtime = p2;
+   void *p3 = realloc(lw.idxrec, (lw.nblk + 1) * sizeof(uint32_t));
+   if(p3 != NULL) lw.idxrec = p3;
+   if(p1 == NULL || p2 == NULL || p3 == NULL) {
+      /* ----------------------------------------------------- *
+       * The block is still written, only without its index    *
+       * entry: a seek lands on the block before, and decodes  *
+       * on from there.                                        *
+       * ----------------------------------------------------- */
+      printf("Error: out of memory for the log block index.\n");
+   }
+   else {
+      lw.idxoff[lw.nblk] = ftell(lw.fp);
+      lw.idxtime[lw.nblk] = lw.first;
+      lw.idxrec[lw.nblk] = lw.brec;
+      lw.nblk++;
+   }
+
+   memcpy(hdr, BNO_LOG_BLKMAGIC, 4);
+   put_le(hdr + 4, lw.blen, 4);
+   put_le(hdr + 8, lw.brec, 4);
+   put_le(hdr + 12, lw.first, 8);
+   if(fwrite(hdr, 1, sizeof(hdr), lw.fp) != sizeof(hdr)
+      || fwrite(lw.blk, 1, lw.blen, lw.fp) != (size_t) lw.blen)
+      printf("Error: log block write failure.\n");
+   lw.blen = 0;
+   lw.brec = 0;
+}
+
+/* ------------------------------------------------------------ *
+ * log_encode() appends one record to the current block. The    *
+ * first record of a block is the keyframe with absolute data.  *
+ * ------------------------------------------------------------ */
+static void log_encode(struct bnoraw *r) {
+   int64_t us = ts_usec(&r->ts);
+   int i;
+
+   if(lw.brec > 0 && us - lw.first >= BNO_LOG_BLOCKMS * 1000) log_flush();
+   unsigned char *p = lw.blk + lw.blen;
+
+   if(lw.brec == 0) {
+      lw.first = us;
+      for(i = 0; i < lw.nval; i++) p += put_varint(p, r->val[lw.idx[i]]);
+   }
+   else {
+      p += put_varint(p, us - lw.prev);
+      for(i = 0; i < lw.nval; i++)
+         p += put_varint(p, (int32_t) r->val[lw.idx[i]] - lw.last.val[lw.idx[i]]);
+   }
+   lw.blen = p - lw.blk;
+   lw.prev = us;
+   lw.last = *r;
+   lw.records++;
+   if(++lw.brec == BNO_LOG_BLOCKRECS) log_flush();
+}
+
+/* ------------------------------------------------------------ *
+ * log_thread() encodes queued records until log_close() stops  *
+ * ------------------------------------------------------------ */
+static void *log_thread(void *arg) {
+   struct bnoraw r;
+
+   pthread_mutex_lock(&lw.lock);
+   while(1) {
+      while(lw.head == lw.tail && lw.stop == 0) pthread_cond_wait(&lw.cond, &lw.lock);
+      if(lw.head == lw.tail) break;
+      r = lw.queue[lw.tail % LOG_QUEUESIZE];
+      lw.tail++;
+      pthread_mutex_unlock(&lw.lock);
+      log_encode(&r);
+      pthread_mutex_lock(&lw.lock);
+   }
+   pthread_mutex_unlock(&lw.lock);
+   log_flush();
+   return(arg);
+}
+
+/* ------------------------------------------------------------ *
+ * log_open() creates the log file for the channels in mask and *
+ * starts the writer thread. unitsel is stored for decoding.    *
+ * ------------------------------------------------------------ */
+int log_open(char *file, int mask, int unitsel) {
+   unsigned char hdr[BNO_LOG_HDRLEN] = {0};
+
+   if(! (lw.fp = fopen(file, "w"))) {
+      printf("Error: Can't open %s for writing.\n", file);
+      return(-1);
+   }
+   lw.nval = log_index(mask, lw.idx);
+
+   memcpy(hdr, BNO_LOG_MAGIC, 4);
+   hdr[4] = BNO_LOG_VERSION;
+   hdr[5] = BNO_LOG_HDRLEN;
+   put_le(hdr + 6, mask, 2);
+   hdr[8] = unitsel;
+   put_le(hdr + 10, BNO_LOG_BLOCKRECS, 2);
+   if(fwrite(hdr, 1, sizeof(hdr), lw.fp) != sizeof(hdr)) {
+      printf("Error: log header write failure for %s.\n", file);
+      fclose(lw.fp);
+      return(-1);
+   }
+
+   if(pthread_create(&lw.thread, NULL, log_thread, NULL) != 0) {
+      printf("Error: cannot start log writer thread.\n");
+      fclose(lw.fp);
+      return(-1);
+   }
+   if(verbose == 1) printf("Debug: Log file [%s] mask [0x%02X] values [%d]\n", file, mask, lw.nval);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * log_write() queues a record for the writer thread. A full    *
+ * queue drops the record, acquisition is never blocked by I/O. *
+ * ------------------------------------------------------------ */
+void log_write(struct bnoraw *r) {
+   if(lw.fp == NULL) return;
+   pthread_mutex_lock(&lw.lock);
+   if(lw.head - lw.tail < LOG_QUEUESIZE) {
+      lw.queue[lw.head % LOG_QUEUESIZE] = *r;
+      lw.head++;
+      pthread_cond_signal(&lw.cond);
+   }
+   else lw.dropped++;
+   pthread_mutex_unlock(&lw.lock);
+}
+
+/* ------------------------------------------------------------ *
+ * log_close() drains the queue, writes the block index and the *
+ * trailer pointing to it, and closes the log file.             *
+ * ------------------------------------------------------------ */
+int log_close() {
+   unsigned char buf[BNO_LOG_ENDLEN];
+   int i, res = 0;
+
+   if(lw.fp == NULL) return(0);
+   pthread_mutex_lock(&lw.lock);
+   lw.stop = 1;
+   pthread_cond_signal(&lw.cond);
+   pthread_mutex_unlock(&lw.lock);
+   pthread_join(lw.thread, NULL);
+
+   uint64_t idxoff = ftell(lw.fp);
+   memcpy(buf, BNO_LOG_IDXMAGIC, 4);
+   put_le(buf + 4, lw.nblk, 4);
+   fwrite(buf, 1, 8, lw.fp);
+   for(i = 0; i < lw.nblk; i++) {
+      put_le(buf, lw.idxoff[i], 8);
+      put_le(buf + 8, lw.idxtime[i], 8);
+      put_le(buf + 16, lw.idxrec[i], 4);
+      fwrite(buf, 1, BNO_LOG_IDXLEN, lw.fp);
+   }
+   put_le(buf, idxoff, 8);
+   put_le(buf + 8, lw.prev, 8);
+   memcpy(buf + 16, BNO_LOG_ENDMAGIC, 4);
+   if(fwrite(buf, 1, BNO_LOG_ENDLEN, lw.fp) != BNO_LOG_ENDLEN) res = -1;
+   long size = ftell(lw.fp);
+   if(fclose(lw.fp) != 0) res = -1;
+   lw.fp = NULL;
+
+   if(verbose == 1) {
+      long rawsize = lw.records * (8 + 2 * lw.nval);
+      printf("Debug: Log records [%lu] dropped [%lu] blocks [%d]\n", lw.records, lw.dropped, lw.nblk);
+      printf("Debug: Log size [%ld] raw size [%ld] ratio [%.2f]\n", size, rawsize,
+             size > 0 ? (double) rawsize / size : 0.0);
+   }
+   free(lw.idxoff);
+   free(lw.idxtime);
+   free(lw.idxrec);
+   return(res);
+}
+
+/* ------------------------------------------------------------ *
+ * log_ropen() maps a log file for reading with log_read(). The *
+ * trailer locates the time index. A log without trailer, e.g.  *
+ * after a crash, can still be read sequentially, but no seek.  *
+ * ------------------------------------------------------------ */
+int log_ropen(struct bnolog *log, char *file) {
+   struct stat st;
+   int fd;
+
+   memset(log, 0, sizeof(*log));
+   if((fd = open(file, O_RDONLY)) < 0) {
+      printf("Error: Can't open %s for reading.\n", file);
+      return(-1);
+   }
+   if(fstat(fd, &st) != 0 || st.st_size < BNO_LOG_HDRLEN) {
+      printf("Error: %s is not a BNO055 log file.\n", file);
+      close(fd);
+      return(-1);
+   }
+   log->size = st.st_size;
+   log->map = mmap(NULL, log->size, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+   if(log->map == MAP_FAILED) {
+      printf("Error: Can't map %s for reading.\n", file);
+      log->map = NULL;
+      return(-1);
+   }
+   if(memcmp(log->map, BNO_LOG_MAGIC, 4) != 0 || log->map[4] != BNO_LOG_VERSION) {
+      printf("Error: %s is not a BNO055 log file.\n", file);
+      log_rclose(log);
+      return(-1);
+   }
+   log->next = log->map[5];
+   log->mask = get_le(log->map + 6, 2);
+   log->unitsel = log->map[8];
+   log->nval = log_index(log->mask, log->idx);
+
+   /* -------------------------------------------------------- *
+    * Locate the index through the trailer, and validate it    *
+    * -------------------------------------------------------- */
+   const unsigned char *end = log->map + log->size - BNO_LOG_ENDLEN;
+   if(log->size >= BNO_LOG_HDRLEN + BNO_LOG_ENDLEN + 8
+      && memcmp(end + 16, BNO_LOG_ENDMAGIC, 4) == 0) {
+      uint64_t off = get_le(end, 8);
+      if(off + 8 <= log->size && memcmp(log->map + off, BNO_LOG_IDXMAGIC, 4) == 0) {
+         log->nblk = get_le(log->map + off + 4, 4);
+         log->index = log->map + off + 8;
+         if(log->index + (size_t) log->nblk * BNO_LOG_IDXLEN > end) {
+            log->index = NULL;
+            log->nblk = 0;
+         }
+         log->last = get_le(end + 8, 8);
+      }
+   }
+   if(log->nblk > 0) log->first = get_le(log->index + 8, 8);
+   if(verbose == 1) printf("Debug: Log [%s] size [%zu] indexed blocks [%d]\n", file, log->size, log->nblk);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * log_read() decodes the next record into r. Returns 0 for a   *
+ * record, 1 at the end of the data, and -1 on a corrupt file.  *
+ * ------------------------------------------------------------ */
+int log_read(struct bnolog *log, struct bnoraw *r) {
+   int64_t val, us;
+   int i;
+
+   if(log->nrec == log->brec) {
+      const unsigned char *hdr = log->map + log->next;
+      if(log->next + BNO_LOG_BLKHDRLEN > log->size
+         || memcmp(hdr, BNO_LOG_BLKMAGIC, 4) != 0) return(1);
+      log->blen = get_le(hdr + 4, 4);
+      log->brec = get_le(hdr + 8, 4);
+      if(log->next + BNO_LOG_BLKHDRLEN + log->blen > log->size) return(-1);
+      log->blk = hdr + BNO_LOG_BLKHDRLEN;
+      log->next += BNO_LOG_BLKHDRLEN + log->blen;
+      log->bpos = 0;
+      log->nrec = 0;
+      us = get_le(hdr + 12, 8);
+   }
+   else {
+      if(get_varint(log->blk, &log->bpos, log->blen, &val) != 0) return(-1);
+      us = ts_usec(&log->prev.ts) + val;
+   }
+
+   *r = log->prev;
+   for(i = 0; i < log->nval; i++) {
+      if(get_varint(log->blk, &log->bpos, log->blen, &val) != 0) return(-1);
+      if(log->nrec == 0) r->val[log->idx[i]] = val;
+      else r->val[log->idx[i]] += val;
+   }
+   r->ts.tv_sec = us / 1000000;
+   r->ts.tv_nsec = (us % 1000000) * 1000;
+   r->mask = log->mask;
+   log->prev = *r;
+   log->nrec++;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * log_seek() positions the reader on the block containing time *
+ * us (in usec), found by binary search over the index. The next*
+ * log_read() returns the first record at or after that time.   *
+ * Returns -1 if the log has no index.                          *
+ * ------------------------------------------------------------ */
+int log_seek(struct bnolog *log, int64_t us) {
+   struct bnolog pos;
+   struct bnoraw r;
+   int lo = 0, hi = log->nblk - 1, mid;
+
+   if(log->index == NULL || log->nblk == 0) return(-1);
+
+   while(lo < hi) {              // last block starting at or before us
+      mid = (lo + hi + 1) / 2;
+      if((int64_t) get_le(log->index + mid * BNO_LOG_IDXLEN + 8, 8) <= us) lo = mid;
+      else hi = mid - 1;
+   }
+   log->next = get_le(log->index + lo * BNO_LOG_IDXLEN, 8);
+   log->nrec = log->brec = 0;
+
+   /* -------------------------------------------------------- *
+    * Decode forward, at most one block of BLOCKMS, and return *
+    * to the reader state before the first record at/after us  *
+    * -------------------------------------------------------- */
+   do {
+      pos = *log;
+      if(log_read(log, &r) != 0) break;
+   } while(ts_usec(&r.ts) < us);
+   *log = pos;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * log_rclose() unmaps the log file                             *
+ * ------------------------------------------------------------ */
+void log_rclose(struct bnolog *log) {
+   if(log->map != NULL) munmap((void *) log->map, log->size);
+   log->map = NULL;
+}
@@ -0,0 +1,407 @@
+/* ------------------------------------------------------------ *
+ * file:        out_bno055.c                                    *
+ * purpose:     Output formatting of sensor data samples. One   *
+ *              channel table drives the text, CSV, JSON Lines  *
+ *              and binary frame output, so all data types and  *
+ *              the continuous mode share the same writer code. *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "getbno055.h"
+
+/* ------------------------------------------------------------ *
+ * global variables                                             *
+ * ------------------------------------------------------------ */
+double htmrate = 1.0;  // max snapshot file refreshs per second
+
+/* ------------------------------------------------------------ *
+ * Channel table, ordered by register address (= mask bit order)*
+ * the data channels and the temperature byte                   *
+ * ------------------------------------------------------------ */
+#define OUT_CHANS  (BNO_CH_COUNT + 1)
+
+static const struct bnochan {
+   int  mask;        // BNO_CH_* bit for this channel
+   char *tag;        // text output line tag, e.g. "ACC"
+   char *key;        // CSV column and JSON key prefix
+   char *axes;       // one character per value, e.g. "xyz"
+   int  prec;        // text output decimal precision
+   char *label[4];   // HTML table label per value
+} chan[OUT_CHANS] = {
+   { BNO_CH_ACC, "ACC", "acc", "xyz",  2,
+     { "Accelerometer X", "Accelerometer Y", "Accelerometer Z" } },
+   { BNO_CH_MAG, "MAG", "mag", "xyz",  2,
+     { "Magnetometer X", "Magnetometer Y", "Magnetometer Z" } },
+   { BNO_CH_GYR, "GYR", "gyr", "xyz",  2,
+     { "Gyroscope X", "Gyroscope Y", "Gyroscope Z" } },
+   { BNO_CH_EUL, "EUL", "eul", "hrp",  4,
+     { "Euler Heading", "Euler Roll", "Euler Pitch" } },
+   { BNO_CH_QUA, "QUA", "qua", "wxyz", 2,
+     { "Quaternation W", "Quaternation X", "Quaternation Y", "Quaternation Z" } },
+   { BNO_CH_LIN, "LIN", "lin", "xyz",  2,
+     { "Linear Acceleration X", "Linear Acceleration Y", "Linear Acceleration Z" } },
+   { BNO_CH_GRA, "GRA", "gra", "xyz",  2,
+     { "Gravity Vector X", "Gravity Vector Y", "Gravity Vector Z" } },
+   { BNO_CH_TMP, "TMP", "tmp", "t",    1,
+     { "Temperature" } }
+};
+
+/* ------------------------------------------------------------ *
+ * get_values() copies the values of one channel into v[], and  *
+ * returns the number of values for this channel.               *
+ * ------------------------------------------------------------ */
+static int get_values(struct bnosample *s, int ch, double *v) {
+   switch(ch) {
+      case BNO_CH_ACC:
+         v[0] = s->acc.adata_x; v[1] = s->acc.adata_y; v[2] = s->acc.adata_z;
+         return(3);
+      case BNO_CH_MAG:
+         v[0] = s->mag.mdata_x; v[1] = s->mag.mdata_y; v[2] = s->mag.mdata_z;
+         return(3);
+      case BNO_CH_GYR:
+         v[0] = s->gyr.gdata_x; v[1] = s->gyr.gdata_y; v[2] = s->gyr.gdata_z;
+         return(3);
+      case BNO_CH_EUL:
+         v[0] = s->eul.eul_head; v[1] = s->eul.eul_roll; v[2] = s->eul.eul_pitc;
+         return(3);
+      case BNO_CH_QUA:
+         v[0] = s->qua.quater_w; v[1] = s->qua.quater_x;
+         v[2] = s->qua.quater_y; v[3] = s->qua.quater_z;
+         return(4);
+      case BNO_CH_LIN:
+         v[0] = s->lin.linacc_x; v[1] = s->lin.linacc_y; v[2] = s->lin.linacc_z;
+         return(3);
+      case BNO_CH_GRA:
+         v[0] = s->gra.gravityx; v[1] = s->gra.gravityy; v[2] = s->gra.gravityz;
+         return(3);
+      case BNO_CH_TMP:
+         v[0] = s->temp;
+         return(1);
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * get_outfmt() translates the -F argument into the format code *
+ * ------------------------------------------------------------ */
+int get_outfmt(char *name) {
+   if(strcmp(name, "txt")   == 0) return(fmt_txt);
+   if(strcmp(name, "csv")   == 0) return(fmt_csv);
+   if(strcmp(name, "jsonl") == 0) return(fmt_jsonl);
+   if(strcmp(name, "bin")   == 0) return(fmt_bin);
+   return(-1);
+}
+
+/* ------------------------------------------------------------ *
+ * put_le() stores n bytes of val in little-endian byte order   *
+ * ------------------------------------------------------------ */
+static unsigned char *put_le(unsigned char *p, uint64_t val, int n) {
+   int i;
+   for(i = 0; i < n; i++) p[i] = (val >> (8 * i)) & 0xFF;
+   return(p + n);
+}
+
+/* ------------------------------------------------------------ *
+ * print_bin() writes one length-prefixed binary frame. Layout, *
+ * all fields little-endian (see BNO_FRAME_* in getbno055.h):   *
+ *  0: 2 byte sync 0xB0 0x55   2: 1 byte version                *
+ *  3: 1 byte header length    4: 2 byte payload length         *
+ *  6: 2 byte channel mask     8: 8 byte timestamp in ns        *
+ * 16: payload, float32 values of each channel in mask order    *
+ * ------------------------------------------------------------ */
+static void print_bin(struct bnosample *s, FILE *fp) {
+   unsigned char frame[BNO_FRAME_HDRLEN + OUT_CHANS * 4 * 4];
+   unsigned char *p = frame + BNO_FRAME_HDRLEN;
+   double v[4];
+   int i, j, n;
+
+   for(i = 0; i < OUT_CHANS; i++) {
+      if(! (s->mask & chan[i].mask)) continue;
+      n = get_values(s, chan[i].mask, v);
+      for(j = 0; j < n; j++) {
+         float f = (float) v[j];
+         uint32_t u;
+         memcpy(&u, &f, sizeof(u));
+         p = put_le(p, u, 4);
+      }
+   }
+
+   uint64_t ns = (uint64_t) s->ts.tv_sec * 1000000000ULL + s->ts.tv_nsec;
+   unsigned char *h = frame;
+   *h++ = BNO_FRAME_SYNC0;
+   *h++ = BNO_FRAME_SYNC1;
+   *h++ = BNO_FRAME_VERSION;
+   *h++ = BNO_FRAME_HDRLEN;
+   h = put_le(h, p - frame - BNO_FRAME_HDRLEN, 2);
+   h = put_le(h, s->mask, 2);
+   put_le(h, ns, 8);
+   fwrite(frame, 1, p - frame, fp);
+}
+
+/* ------------------------------------------------------------ *
+ * format_json() renders a sample as one JSON Lines record into *
+ * buf with snprintf(), without a stdio stream or heap memory.  *
+ * Returns the length, or -1 if the record does not fit.        *
+ * ------------------------------------------------------------ */
+int format_json(struct bnosample *s, char *buf, int size) {
+   double v[4];
+   int i, j, n;
+
+   int len = snprintf(buf, size, "{\"time\":%lld.%06ld", (long long) s->ts.tv_sec, s->ts.tv_nsec / 1000);
+   for(i = 0; i < OUT_CHANS && len < size; i++) {
+      if(! (s->mask & chan[i].mask)) continue;
+      n = get_values(s, chan[i].mask, v);
+      len += snprintf(buf + len, size - len, ",\"%s\":{", chan[i].key);
+      for(j = 0; j < n && len < size; j++)
+         len += snprintf(buf + len, size - len, "%s\"%c\":%f", (j ? "," : ""), chan[i].axes[j], v[j]);
+      if(len < size) len += snprintf(buf + len, size - len, "}");
+   }
+   if(len < size) len += snprintf(buf + len, size - len, "}\n");
+   return(len < size ? len : -1);
+}
+
+/* ------------------------------------------------------------ *
+ * print_sample() writes the channels in s->mask to fp, using   *
+ * the output format fmt. CSV writes a header line before the   *
+ * first record, and again whenever the channel set changes.    *
+ * The header state is per thread, e.g. for recorder exports.   *
+ * ------------------------------------------------------------ */
+void print_sample(struct bnosample *s, int fmt, FILE *fp) {
+   static __thread int csvmask = 0;
+   double v[4];
+   int i, j, n;
+
+   if(fmt == fmt_bin) { print_bin(s, fp); return; }
+   if(fmt == fmt_jsonl) {
+      char line[BNO_JSONSIZE];
+      n = format_json(s, line, sizeof(line));
+      if(n > 0) fwrite(line, 1, n, fp);
+      return;
+   }
+
+   if(fmt == fmt_csv && csvmask != s->mask) {
+      fprintf(fp, "time");
+      for(i = 0; i < OUT_CHANS; i++) {
+         if(! (s->mask & chan[i].mask)) continue;
+         for(j = 0; chan[i].axes[j]; j++)
+            fprintf(fp, ",%s_%c", chan[i].key, chan[i].axes[j]);
+      }
+      fprintf(fp, "\n");
+      csvmask = s->mask;
+   }
+
+   if(fmt == fmt_csv)
+      fprintf(fp, "%lld.%06ld", (long long) s->ts.tv_sec, s->ts.tv_nsec / 1000);
+
+   for(i = 0; i < OUT_CHANS; i++) {
+      if(! (s->mask & chan[i].mask)) continue;
+      n = get_values(s, chan[i].mask, v);
+      switch(fmt) {
+         case fmt_txt:
+            /* ------------------------------------------------- *
+             * Example: ACC -45.00 264.00 939.00 (ACC X Y Z)     *
+             * ------------------------------------------------- */
+            fprintf(fp, "%s", chan[i].tag);
+            for(j = 0; j < n; j++) fprintf(fp, " %3.*f", chan[i].prec, v[j]);
+            fprintf(fp, "\n");
+            break;
+         case fmt_csv:
+            for(j = 0; j < n; j++) fprintf(fp, ",%f", v[j]);
+            break;
+      }
+   }
+
+   if(fmt == fmt_csv) fprintf(fp, "\n");
+}
+
+/* ------------------------------------------------------------ *
+ * print_plan() writes the bursts of a read plan, and its bus   *
+ * time estimate next to the one for a single covering burst    *
+ * ------------------------------------------------------------ */
+void print_plan(struct bnoplan *p, FILE *fp) {
+   int i;
+   fprintf(fp, "Read plan: mask [0x%03X] %d burst%s at %d kHz:", p->mask, p->count,
+           p->count > 1 ? "s" : "", p->khz);
+   for(i = 0; i < p->count; i++) fprintf(fp, " 0x%02X+%d", p->reg[i], p->len[i]);
+   fprintf(fp, ", %d bytes for %d, %.0f us (single burst %.0f us)\n",
+           p->bytes, p->used, p->cost, p->single);
+}
+
+/* ------------------------------------------------------------ *
+ * print_regs() writes a register map dump in the format fmt.   *
+ * With prev, bytes that changed since the previous dump are    *
+ * highlighted in text on a terminal, and listed in JSON. The   *
+ * binary frame has the BNO_FRAME_REGMAP mask and both pages as *
+ * payload. CSV is written as text.                             *
+ * ------------------------------------------------------------ */
+void print_regs(struct bnoregs *r, struct bnoregs *prev, int fmt, FILE *fp) {
+   int pg, i;
+
+   if(fmt == fmt_bin) {
+      unsigned char frame[BNO_FRAME_HDRLEN + 2 * BNO_PAGE_SIZE];
+      unsigned char *h = frame;
+      uint64_t ns = (uint64_t) r->ts.tv_sec * 1000000000ULL + r->ts.tv_nsec;
+      *h++ = BNO_FRAME_SYNC0;
+      *h++ = BNO_FRAME_SYNC1;
+      *h++ = BNO_FRAME_VERSION;
+      *h++ = BNO_FRAME_HDRLEN;
+      h = put_le(h, 2 * BNO_PAGE_SIZE, 2);
+      h = put_le(h, BNO_FRAME_REGMAP, 2);
+      put_le(h, ns, 8);
+      memcpy(frame + BNO_FRAME_HDRLEN, r->page, 2 * BNO_PAGE_SIZE);
+      fwrite(frame, 1, sizeof(frame), fp);
+      return;
+   }
+
+   if(fmt == fmt_jsonl) {
+      fprintf(fp, "{\"time\":%lld.%06ld", (long long) r->ts.tv_sec, r->ts.tv_nsec / 1000);
+      for(pg = 0; pg < 2; pg++) {
+         fprintf(fp, ",\"page%d\":\"", pg);
+         for(i = 0; i < BNO_PAGE_SIZE; i++) fprintf(fp, "%02X", r->page[pg][i]);
+         fprintf(fp, "\"");
+      }
+      if(prev != NULL) {
+         fprintf(fp, ",\"changed\":{");
+         for(pg = 0; pg < 2; pg++) {
+            int n = 0;
+            fprintf(fp, "%s\"page%d\":[", (pg ? "," : ""), pg);
+            for(i = 0; i < BNO_PAGE_SIZE; i++)
+               if(r->page[pg][i] != prev->page[pg][i]) fprintf(fp, "%s%d", (n++ ? "," : ""), i);
+            fprintf(fp, "]");
+         }
+         fprintf(fp, "}");
+      }
+      fprintf(fp, "}\n");
+      return;
+   }
+
+   /* -------------------------------------------------------- *
+    * Text table, 16 registers per line, changed bytes in      *
+    * reverse video if the output is a terminal                *
+    * -------------------------------------------------------- */
+   int tty = prev != NULL && isatty(fileno(fp));
+   for(pg = 0; pg < 2; pg++) {
+      fprintf(fp, "------------------------------------------------------\n");
+      fprintf(fp, "BNO055 page-%d:\n", pg);
+      fprintf(fp, "------------------------------------------------------\n");
+      fprintf(fp, " reg    0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F\n");
+      fprintf(fp, "------------------------------------------------------\n");
+      for(i = 0; i < BNO_PAGE_SIZE; i++) {
+         int chg = tty && r->page[pg][i] != prev->page[pg][i];
+         if(i % 16 == 0) fprintf(fp, "[0x%02X]", i);
+         fprintf(fp, chg ? " \033[7m%02X\033[0m" : " %02X", r->page[pg][i]);
+         if(i % 16 == 15) fprintf(fp, "\n");
+      }
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * read_regs() reads a register map frame as written by         *
+ * print_regs() with fmt_bin. Returns 0, or -1 if fp holds no   *
+ * valid register map frame.                                    *
+ * ------------------------------------------------------------ */
+int read_regs(FILE *fp, struct bnoregs *r) {
+   unsigned char h[BNO_FRAME_HDRLEN];
+   uint64_t ns = 0;
+   int i;
+
+   if(fread(h, 1, sizeof(h), fp) != sizeof(h)) return(-1);
+   if(h[0] != BNO_FRAME_SYNC0 || h[1] != BNO_FRAME_SYNC1 || h[3] != BNO_FRAME_HDRLEN
+      || (h[4] | h[5] << 8) != 2 * BNO_PAGE_SIZE || (h[6] | h[7] << 8) != BNO_FRAME_REGMAP)
+      return(-1);
+   for(i = 7; i >= 0; i--) ns = (ns << 8) | h[8 + i];
+   r->ts.tv_sec = ns / 1000000000ULL;
+   r->ts.tv_nsec = ns % 1000000000ULL;
+   if(fread(r->page, 1, 2 * BNO_PAGE_SIZE, fp) != 2 * BNO_PAGE_SIZE) return(-1);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * print_html() writes the channels in s->mask as HTML table.   *
+ * This single template serves all data types for the -o file.  *
+ * ------------------------------------------------------------ */
+void print_html(struct bnosample *s, FILE *fp) {
+   double v[4];
+   int i, j, n, cells = 0;
+
+   fprintf(fp, "<table><tr>\n");
+   for(i = 0; i < OUT_CHANS; i++) {
+      if(! (s->mask & chan[i].mask)) continue;
+      n = get_values(s, chan[i].mask, v);
+      for(j = 0; j < n; j++) {
+         if(cells++ > 0) fprintf(fp, "<td class=\"sensorspace\"></td>\n");
+         fprintf(fp, "<td class=\"sensordata\">%s:<span class=\"sensorvalue\">%3.*f</span></td>\n",
+                 chan[i].label[j], chan[i].prec, v[j]);
+      }
+   }
+   fprintf(fp, "</tr></table>\n");
+}
+
+/* ------------------------------------------------------------ *
+ * write_snapshot() renders the sample into a memory stream and *
+ * replaces file atomically: the data goes to "<file>.tmp" that *
+ * is then renamed, so a web server never reads a partial file. *
+ * Files ending in ".json" get a JSON object instead of HTML.   *
+ * Calls faster than htmrate per second are skipped, returns 0. *
+ * ------------------------------------------------------------ */
+int write_snapshot(char *file, struct bnosample *s) {
+   static char tmpfile[280];
+   static struct timespec last;
+   static int jsonflag = 0;
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   if(tmpfile[0] == '\0') {
+      size_t len = strlen(file);
+      snprintf(tmpfile, sizeof(tmpfile), "%s.tmp", file);
+      if(len > 5 && strcmp(file + len - 5, ".json") == 0) jsonflag = 1;
+   }
+   else if(htmrate > 0) {
+      double elapsed = (now.tv_sec - last.tv_sec) + (now.tv_nsec - last.tv_nsec) / 1e9;
+      if(elapsed < 1.0 / htmrate) return(0);
+   }
+   last = now;
+
+   /* -------------------------------------------------------- *
+    *  Render into a stream that grows with the output, so all *
+    *  channels fit, then write it with one syscall            *
+    * -------------------------------------------------------- */
+   char *buf = NULL;
+   size_t len = 0;
+   FILE *mem = open_memstream(&buf, &len);
+   if(mem == NULL) return(-1);
+   if(jsonflag == 1) print_sample(s, fmt_jsonl, mem);
+   else print_html(s, mem);
+   if(fclose(mem) != 0) {
+      printf("Error: out of memory for %s.\n", file);
+      free(buf);
+      return(-1);
+   }
+
+   int fd = open(tmpfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+   if(fd < 0) {
+      printf("Error: Can't open %s for writing.\n", tmpfile);
+      free(buf);
+      return(-1);
+   }
+   ssize_t out = write(fd, buf, len);
+   close(fd);
+   free(buf);
+   if(out != (ssize_t) len) {
+      printf("Error: write failure for %s.\n", tmpfile);
+      return(-1);
+   }
+
+   if(rename(tmpfile, file) != 0) {
+      printf("Error: cannot rename %s to %s.\n", tmpfile, file);
+      return(-1);
+   }
+   return(0);
+}
@@ -0,0 +1,214 @@
+/* ------------------------------------------------------------ *
+ * file:        plan_bno055.c                                   *
+ * purpose:     Read planner for any set of data channels, e.g. *
+ *              "-t acc,gyr,qua,temp". The requested channels   *
+ *              are mapped onto the registers 0x08-0x3D, and    *
+ *              the runs of needed bytes are read with as many  *
+ *              bursts as the bus time is lowest. Each burst    *
+ *              costs a fixed overhead: two transfers (register *
+ *              address, then data) with their host syscall and *
+ *              the address bytes on the bus. Each byte costs 9 *
+ *              bus clocks. So a gap of unneeded registers is   *
+ *              read along if that is cheaper than one more     *
+ *              burst, and every gap is decided on its own.     *
+ *              A gap that holds INT_STA 0x37 is never read     *
+ *              along, the sensor clears it on read.            *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "getbno055.h"
+
+#define PLAN_LO   BNO055_ACC_DATA_X_LSB_ADDR   // first data register
+#define PLAN_HI   (BNO055_OPR_MODE_ADDR + 1)   // end of the status registers
+
+static const char *names[] = { "acc", "mag", "gyr", "eul", "qua", "lin", "gra", "temp" };
+
+/* ------------------------------------------------------------ *
+ * bno_plan_mask() translates a comma separated list of data    *
+ * types, e.g. "acc,gyr,qua,temp" into BNO_CH_* bits, or -1.    *
+ * ------------------------------------------------------------ */
+int bno_plan_mask(const char *list) {
+   char buf[256];
+   char *tok, *save = NULL;
+   int mask = 0, i, n = sizeof(names) / sizeof(names[0]);
+
+   if(strlen(list) >= sizeof(buf)) return(-1);
+   strcpy(buf, list);
+   for(tok = strtok_r(buf, ",", &save); tok != NULL; tok = strtok_r(NULL, ",", &save)) {
+      for(i = 0; i < n; i++) if(strcmp(tok, names[i]) == 0) break;
+      if(i == n) {
+         bno_error("invalid data type %s.\n", tok);
+         return(-1);
+      }
+      mask |= 1 << i;
+   }
+   return(mask == 0 ? -1 : mask);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_plan_khz() returns the bus clock of an i2c-dev device    *
+ * from the device tree, or BNO_PLAN_KHZ if it is not known.    *
+ * ------------------------------------------------------------ */
+int bno_plan_khz(const char *dev) {
+   const char *name = strrchr(dev, '/');
+   char path[256];
+   unsigned char be[4];
+   FILE *fp;
+
+   if(name == NULL) return(BNO_PLAN_KHZ);
+   snprintf(path, sizeof(path), "/sys/class/i2c-dev%s/device/of_node/clock-frequency", name);
+   if(! (fp = fopen(path, "r"))) return(BNO_PLAN_KHZ);
+   int n = fread(be, 1, 4, fp);
+   fclose(fp);
+   if(n != 4) return(BNO_PLAN_KHZ);
+   int hz = (be[0] << 24) | (be[1] << 16) | (be[2] << 8) | be[3];
+   return(hz >= 1000 ? hz / 1000 : BNO_PLAN_KHZ);
+}
+
+/* ------------------------------------------------------------ *
+ * plan_cost() estimates the bus time of n bursts with a total  *
+ * of bytes in usec. A burst is a write of the sensor address + *
+ * register (2 bytes), then a read of the address + data, plus  *
+ * start and stop conditions, about 4 clocks per transfer.      *
+ * ------------------------------------------------------------ */
+static double plan_cost(int n, int bytes, int khz) {
+   double clk = 1000.0 / khz;   // usec per bus clock
+   return(n * (2 * BNO_PLAN_XFER_US + (3 * 9 + 8) * clk) + bytes * 9 * clk);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_plan() computes the bursts that read the channels in     *
+ * mask on a bus with khz clock. BNO_RAW_STATUS adds the status *
+ * registers 0x39, 0x3A, 0x3D, BNO_RAW_CALIB CALIB_STAT 0x35.   *
+ * Returns 0, or -1.                                            *
+ * ------------------------------------------------------------ */
+int bno_plan(struct bnoplan *p, int mask, int khz) {
+   unsigned char need[PLAN_HI];
+   int i, n, idx, reg;
+
+   memset(p, 0, sizeof(*p));
+   memset(need, 0, sizeof(need));
+   p->mask = mask & (BNO_CH_ALL | BNO_CH_TMP | BNO_RAW_STATUS | BNO_RAW_CALIB);
+   p->khz = khz > 0 ? khz : BNO_PLAN_KHZ;
+
+   for(i = 0; i < BNO_CH_COUNT; i++) {
+      if(! (mask & (1 << i))) continue;
+      idx = bno_raw_chan(1 << i, &n);
+      memset(need + PLAN_LO + 2 * idx, 1, 2 * n);
+   }
+   if(mask & BNO_CH_TMP) need[BNO055_TEMP_ADDR] = 1;
+   if(mask & BNO_RAW_CALIB) need[BNO055_CALIB_STAT_ADDR] = 1;
+   if(mask & BNO_RAW_STATUS) {
+      need[BNO055_SYS_STAT_ADDR] = 1;
+      need[BNO055_SYS_ERR_ADDR] = 1;
+      need[BNO055_OPR_MODE_ADDR] = 1;
+   }
+
+   /* -------------------------------------------------------- *
+    * Runs of needed bytes, and the gaps between them          *
+    * -------------------------------------------------------- */
+   int count = 0, start[PLAN_HI], end[PLAN_HI];
+   for(reg = PLAN_LO; reg < PLAN_HI; reg++) {
+      if(! need[reg]) continue;
+      p->used++;
+      if(count > 0 && end[count-1] == reg) { end[count-1]++; continue; }
+      start[count] = reg;
+      end[count++] = reg + 1;
+   }
+   if(count == 0) {
+      bno_error("no data channels to read.\n");
+      return(-1);
+   }
+
+   /* -------------------------------------------------------- *
+    * A gap is read along if its bytes cost no more than one   *
+    * more burst. If there are still too many bursts for the   *
+    * plan, the smallest gaps are read along, INT_STA last.    *
+    * -------------------------------------------------------- */
+   double perburst = plan_cost(1, 0, p->khz);
+   double perbyte = plan_cost(0, 1, p->khz);
+   int merge[PLAN_HI], intsta[PLAN_HI], bursts = count;
+   for(i = 0; i < count - 1; i++) {
+      int gap = start[i+1] - end[i];
+      intsta[i] = end[i] <= BNO055_INTR_STAT_ADDR && start[i+1] > BNO055_INTR_STAT_ADDR;
+      merge[i] = intsta[i] == 0 && gap * perbyte <= perburst;
+      bursts -= merge[i];
+   }
+   while(bursts > BNO_PLAN_MAX) {
+      int min = -1;
+      for(i = 0; i < count - 1; i++) {
+         if(merge[i]) continue;
+         int key = start[i+1] - end[i] + intsta[i] * PLAN_HI;
+         if(min < 0 || key < start[min+1] - end[min] + intsta[min] * PLAN_HI) min = i;
+      }
+      merge[min] = 1;
+      bursts--;
+   }
+
+   for(i = 0; i < count; i++) {
+      if(i > 0 && merge[i-1]) {
+         p->len[p->count-1] = end[i] - p->reg[p->count-1];
+         continue;
+      }
+      p->reg[p->count] = start[i];
+      p->len[p->count++] = end[i] - start[i];
+   }
+   for(i = 0; i < p->count; i++) p->bytes += p->len[i];
+   p->cost = plan_cost(p->count, p->bytes, p->khz);
+   p->single = plan_cost(1, end[count-1] - start[0], p->khz);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_get_plan() runs the bursts of a plan, and fills the      *
+ * channel values, temperature and status of raw like           *
+ * bno_get_raw() does. t0 is taken before the first burst, t1   *
+ * after the last one.                                          *
+ * ------------------------------------------------------------ */
+int bno_get_plan(struct bnoplan *p, struct bnoraw *raw) {
+   unsigned char data[PLAN_HI];
+   struct timespec mono;
+   int i, n, idx;
+
+   clock_gettime(CLOCK_MONOTONIC, &mono);
+   raw->t0 = (int64_t) mono.tv_sec * 1000000000 + mono.tv_nsec;
+
+   for(i = 0; i < p->count; i++) {
+      char reg = p->reg[i];
+      if(bno_bus_write(&reg, 1) != 1) {
+         bno_error("I2C write failure for register 0x%02X\n", reg);
+         return(-1);
+      }
+      if(bno_debug == 1) printf("Debug: I2C read %d bytes starting at register 0x%02X\n", p->len[i], reg);
+      if(bno_bus_read(data + p->reg[i], p->len[i]) != p->len[i]) {
+         bno_error("I2C read failure for register data 0x%02X\n", reg);
+         return(-1);
+      }
+   }
+   clock_gettime(CLOCK_MONOTONIC, &mono);
+   clock_gettime(CLOCK_REALTIME, &raw->ts);
+   raw->t1 = (int64_t) mono.tv_sec * 1000000000 + mono.tv_nsec;
+
+   for(i = 0; i < BNO_CH_COUNT; i++) {
+      if(! (p->mask & (1 << i))) continue;
+      idx = bno_raw_chan(1 << i, &n);
+      for(n += idx; idx < n; idx++) {
+         unsigned char *d = data + PLAN_LO + 2 * idx;
+         raw->val[idx] = ((int16_t)d[1] << 8) | d[0];
+      }
+   }
+   raw->mask = p->mask & (BNO_CH_ALL | BNO_CH_TMP);
+   if(p->mask & BNO_CH_TMP) raw->temp = (int8_t) data[BNO055_TEMP_ADDR];
+   if(p->mask & BNO_RAW_CALIB) raw->calstat = data[BNO055_CALIB_STAT_ADDR];
+   if(p->mask & BNO_RAW_STATUS) {
+      raw->sysstat = data[BNO055_SYS_STAT_ADDR];
+      raw->syserr  = data[BNO055_SYS_ERR_ADDR];
+      raw->oprmode = data[BNO055_OPR_MODE_ADDR] & 0x0F;
+   }
+   return(0);
+}
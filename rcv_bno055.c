@@ -0,0 +1,186 @@
+/* ------------------------------------------------------------ *
+ * file:        rcv_bno055.c                                    *
+ * purpose:     Sensor recovery for the continuous mode. Single *
+ *              failed transfers are already repeated by the    *
+ *              bus transport. When a read still fails, the     *
+ *              recovery reopens the bus with exponential back- *
+ *              off until the sensor answers with its chip id,  *
+ *              and checks the operations mode. A sensor that   *
+ *              lost its setup, e.g. after a brown-out reset,   *
+ *              gets its register map setup and mode back.      *
+ *              If that does not work, it is reset first. The   *
+ *              time to recover is measured for the report.     *
+ *              The health check uses the status registers read *
+ *              with the data burst: a sensor that still answers*
+ *              but dropped to CONFIG mode or reports a system  *
+ *              error is restored, or reset and restored, right *
+ *              away. The downtime counts from the last healthy *
+ *              sample until the sensor runs again.             *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "getbno055.h"
+
+#define RCV_CALLO      ACC_OFFSET_X_LSB_ADDR   // calibration 0x55..0x6A
+#define RCV_CALHI      MAG_RADIUS_MSB_ADDR
+
+/* ------------------------------------------------------------ *
+ * Recovery state: the setup to restore, and the statistics     *
+ * ------------------------------------------------------------ */
+static struct {
+   int mode;                         // operations mode to restore
+   int calsaved;                     // 1 = restore the calibration
+   struct bnoregs snap;              // register map setup at start
+   unsigned long count;              // recoveries
+   unsigned long resets;             // recoveries with a sensor reset
+   unsigned long failed;             // recoveries that gave up
+   int64_t total, max;               // time to recover in nsec
+   int64_t lastgood;                 // t1 of the last healthy sample
+   unsigned long hmode, herr;        // health failures: mode, SYS_ERR
+   int lasterr;                      // last SYS_ERR code seen
+   int64_t downtotal, downmax;       // health failure downtime in nsec
+} rcv;
+
+/* ------------------------------------------------------------ *
+ * rcv_init() records the setup to restore with bno_snapshot(): *
+ * both register pages, with units, power mode, clock source,   *
+ * axis remap, calibration, sensor and interrupt configuration. *
+ * The calibration is only restored if the sensor was fully     *
+ * calibrated at start, a partial one is not worth overwriting  *
+ * what the sensor learned since.                               *
+ * ------------------------------------------------------------ */
+int rcv_init(int mode) {
+   struct bnocal bnoc;
+   rcv.mode = mode;
+   rcv.calsaved = bno_get_calstatus(&bnoc) == 0 && bnoc.scal_st == 3;
+   if(bno_snapshot(&rcv.snap) != 0) return(-1);
+   rcv.snap.page[0][BNO055_OPR_MODE_ADDR] = mode;
+   if(verbose == 1) printf("Debug: Recovery setup saved, register map %s calibration\n",
+                           rcv.calsaved ? "with" : "without");
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * rcv_restore() writes the registers that differ from the      *
+ * saved setup with bno_restore(), and switches to the saved    *
+ * mode. Without the saved calibration, the current one stays.  *
+ * ------------------------------------------------------------ */
+static int rcv_restore() {
+   struct bnoregs want = rcv.snap;
+   if(rcv.calsaved == 0) {
+      struct bnoregs cur;
+      if(bno_set_mode(BNO_MODE_CONFIG) != 0 || bno_dump(&cur) != 0) return(-1);
+      memcpy(want.page[0] + RCV_CALLO, cur.page[0] + RCV_CALLO, RCV_CALHI - RCV_CALLO + 1);
+   }
+   return(bno_restore(&want) < 0 ? -1 : 0);
+}
+
+/* ------------------------------------------------------------ *
+ * rcv_detect() returns 0 if the sensor answers with its id     *
+ * ------------------------------------------------------------ */
+static int rcv_detect() {
+   unsigned char reg = BNO055_CHIP_ID_ADDR, id = 0;
+   if(bno_bus_write(&reg, 1) != 1 || bno_bus_read(&id, 1) != 1) return(-1);
+   return(id == BNO055_ID ? 0 : -1);
+}
+
+/* ------------------------------------------------------------ *
+ * rcv_recover() is called after a failed read. It returns 0    *
+ * once the sensor is back in its operations mode, or -1 after  *
+ * BNO_RCV_TRIES attempts, the caller may simply call it again. *
+ * ------------------------------------------------------------ */
+int rcv_recover() {
+   int64_t t0 = bno_trace_now();
+   int n, reset = 0;
+
+   for(n = 0; n < BNO_RCV_TRIES; n++) {
+      if(n > 0) {
+         int wait = BNO_RCV_BACKOFF_US << (n - 1);
+         bno_bus_sleep(wait > 1000000 ? 1000000 : wait, "recover");
+         if(bno_bus_reopen() != 0) continue;
+      }
+      if(rcv_detect() != 0) continue;
+      int mode = bno_get_mode();
+      if(mode < 0) continue;
+      if(mode == rcv.mode) break;
+
+      /* ------------------------------------------------------ *
+       * The sensor lost its setup, restore it, and if that     *
+       * fails, reset the sensor to a defined state and retry   *
+       * ------------------------------------------------------ */
+      if(verbose == 1) printf("Debug: Sensor in mode [0x%02X], restoring mode [0x%02X]\n", mode, rcv.mode);
+      if(rcv_restore() == 0) break;
+      reset = 1;
+      if(bno_reset() == 0 && rcv_restore() == 0) break;
+   }
+
+   int64_t dt = bno_trace_now() - t0;
+   if(n == BNO_RCV_TRIES) {
+      rcv.failed++;
+      printf("Error: Sensor recovery failed after %.3f s.\n", dt / 1e9);
+      return(-1);
+   }
+   rcv.count++;
+   rcv.resets += reset;
+   rcv.total += dt;
+   if(dt > rcv.max) rcv.max = dt;
+   if(verbose == 1) printf("Debug: Sensor recovered in %.3f ms, %d attempts\n", dt / 1e6, n + 1);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * rcv_health() checks the status registers of a sample read    *
+ * with BNO_RAW_STATUS. It returns 0 for a healthy sensor. If   *
+ * the sensor dropped out of its mode, the setup is restored,   *
+ * after a system error the sensor is reset first. Returns 1    *
+ * once the sensor runs again, the sample must be dropped, or   *
+ * -1 if the sensor could not be restored.                      *
+ * ------------------------------------------------------------ */
+int rcv_health(struct bnoraw *raw) {
+   int err = raw->sysstat == 0x01 || raw->syserr != 0;
+   if(err == 0 && raw->oprmode == rcv.mode) {
+      rcv.lastgood = raw->t1;
+      return(0);
+   }
+   if(verbose == 1) printf("Debug: Sensor health SYS_STATUS [0x%02X] SYS_ERR [0x%02X] mode [0x%02X]\n",
+                           raw->sysstat, raw->syserr, raw->oprmode);
+   int res = 0;
+   if(err == 1) {
+      rcv.herr++;
+      rcv.lasterr = raw->syserr;
+      if(bno_reset() != 0 || rcv_restore() != 0) res = rcv_recover();
+   }
+   else {
+      rcv.hmode++;
+      if(rcv_restore() != 0) res = rcv_recover();
+   }
+   if(res != 0) return(-1);
+
+   int64_t down = bno_trace_now() - (rcv.lastgood > 0 ? rcv.lastgood : raw->t0);
+   rcv.downtotal += down;
+   if(down > rcv.downmax) rcv.downmax = down;
+   if(verbose == 1) printf("Debug: Sensor restored, downtime %.3f ms\n", down / 1e6);
+   return(1);
+}
+
+/* ------------------------------------------------------------ *
+ * rcv_report() prints the recoveries and the time to recover   *
+ * ------------------------------------------------------------ */
+void rcv_report(FILE *fp) {
+   unsigned long health = rcv.hmode + rcv.herr;
+   if(health > 0)
+      fprintf(fp, "Health: %lu failures, %lu mode lost, %lu system error (last 0x%02X), "
+              "downtime max %.1f ms, mean %.1f ms\n", health, rcv.hmode, rcv.herr, rcv.lasterr,
+              rcv.downmax / 1e6, rcv.downtotal / 1e6 / health);
+   if(rcv.count == 0 && rcv.failed == 0) return;
+   fprintf(fp, "Recovery: %lu recovered, %lu with reset, %lu failed",
+           rcv.count, rcv.resets, rcv.failed);
+   if(rcv.count > 0)
+      fprintf(fp, ", time to recover max %.1f ms, mean %.1f ms",
+              rcv.max / 1e6, rcv.total / 1e6 / rcv.count);
+   fprintf(fp, "\n");
+}
@@ -0,0 +1,318 @@
+/* ------------------------------------------------------------ *
+ * file:        rec_bno055.c                                    *
+ * purpose:     Flight recorder for the continuous mode. It     *
+ *              keeps the last seconds of raw samples in a ring *
+ *              file mapped into memory, and on a trigger saves *
+ *              the samples before and after it to a new file.  *
+ *              Triggers are the acceleration magnitude going   *
+ *              over a threshold, SIGUSR2, or GET /trigger.     *
+ *                                                              *
+ *              Recording a sample is a copy into the mapping,  *
+ *              without any system call. The kernel writes the  *
+ *              shared pages back, also if the process crashes. *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "getbno055.h"
+
+/* ------------------------------------------------------------ *
+ * Recorder state. A pending trigger is stored in the mapped    *
+ * header, the export runs in its own thread from a copy of the *
+ * window, so that the recording continues without a gap.       *
+ * ------------------------------------------------------------ */
+static struct {
+   char file[256];
+   struct bnorechdr *hdr;            // mapped ring file header
+   struct bnorecslot *slot;          // mapped ring slots
+   size_t size;                      // mapped length
+   int64_t pre;                      // window before trigger in usec
+   int64_t post;                     // window after trigger in usec
+   int64_t thres2;                   // squared raw acc threshold, 0 = off
+   int fmt;                          // export output format
+   volatile sig_atomic_t request;    // trigger from signal or HTTP
+   pthread_t thread;
+   int busy;                         // export thread is running
+   volatile int done;                // export thread has finished
+   struct bnoraw *win;               // copied window for the export
+   int nwin;
+   int unitsel;                      // unit selection of the window
+   int64_t trigger;                  // time of the exported trigger
+   unsigned long triggers;           // triggers that started a window
+   unsigned long skipped;            // triggers lost to a running export
+} rec;
+
+/* ------------------------------------------------------------ *
+ * rec_trigger() requests an export at the next sample. It only *
+ * sets a flag, so it is safe in a signal handler and threads.  *
+ * ------------------------------------------------------------ */
+void rec_trigger() {
+   rec.request = 1;
+}
+
+static void rec_signal(int sig) {
+   rec_trigger();
+}
+
+/* ------------------------------------------------------------ *
+ * rec_export() writes the copied window in the -F format into  *
+ * <ringfile>.<trigger-time>.<format>, from the export thread.  *
+ * ------------------------------------------------------------ */
+static void *rec_export(void *arg) {
+   static const char *ext[] = { "txt", "csv", "jsonl", "bin" };
+   struct bnosample bnos;
+   char outfile[320];
+   struct tm tm;
+   time_t sec = rec.trigger / 1000000;
+   int i;
+
+   localtime_r(&sec, &tm);
+   snprintf(outfile, sizeof(outfile), "%s.%04d%02d%02d-%02d%02d%02d.%s", rec.file,
+            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+            tm.tm_hour, tm.tm_min, tm.tm_sec, ext[rec.fmt]);
+
+   FILE *fp = fopen(outfile, "w");
+   if(fp == NULL) printf("Error: Can't open %s for writing.\n", outfile);
+   else {
+      for(i = 0; i < rec.nwin; i++) {
+         bno_raw_to_sample(&rec.win[i], &bnos, rec.unitsel);
+         print_sample(&bnos, rec.fmt, fp);
+      }
+      if(fclose(fp) != 0) printf("Error: write failure for %s.\n", outfile);
+      else if(verbose == 1) printf("Debug: Recorder saved [%d] samples to [%s]\n", rec.nwin, outfile);
+   }
+   free(rec.win);
+   rec.win = NULL;
+   rec.done = 1;
+   return(arg);
+}
+
+/* ------------------------------------------------------------ *
+ * rec_slot() converts ring slot number n back to a raw sample  *
+ * ------------------------------------------------------------ */
+static void rec_slot(struct bnorecslot *slot, uint32_t nslot, uint64_t n, struct bnoraw *r) {
+   struct bnorecslot *s = &slot[n % nslot];
+   r->ts.tv_sec = s->us / 1000000;
+   r->ts.tv_nsec = (s->us % 1000000) * 1000;
+   r->mask = BNO_CH_ALL;
+   memcpy(r->val, s->val, sizeof(r->val));
+}
+
+/* ------------------------------------------------------------ *
+ * rec_freeze() copies the samples in the trigger window out of *
+ * the ring, and hands them to the export thread.               *
+ * ------------------------------------------------------------ */
+static void rec_freeze() {
+   uint64_t head = rec.hdr->head;
+   uint64_t n, first = head > rec.hdr->nslot ? head - rec.hdr->nslot : 0;
+   int64_t from = rec.hdr->trigger - rec.pre;
+
+   /* oldest sample in the ring that is still inside the window */
+   for(n = first; n < head && rec.slot[n % rec.hdr->nslot].us < from; n++);
+
+   rec.trigger = rec.hdr->trigger;
+   rec.unitsel = rec.hdr->unitsel;
+   rec.hdr->trigger = 0;
+   rec.nwin = head - n;
+   if(rec.nwin == 0) return;
+   if((rec.win = malloc(rec.nwin * sizeof(struct bnoraw))) == NULL) {
+      printf("Error: out of memory for the recorder export.\n");
+      return;
+   }
+   for(first = n; n < head; n++) rec_slot(rec.slot, rec.hdr->nslot, n, &rec.win[n - first]);
+
+   /* -------------------------------------------------------- *
+    * The export never inherits a real-time policy (-T) of the *
+    * acquisition thread, the file I/O runs at normal priority *
+    * -------------------------------------------------------- */
+   pthread_attr_t attr;
+   pthread_attr_init(&attr);
+   pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+   rec.busy = 1;
+   rec.done = 0;
+   int res = pthread_create(&rec.thread, &attr, rec_export, NULL);
+   pthread_attr_destroy(&attr);
+   if(res != 0) {
+      printf("Error: cannot start the recorder export thread.\n");
+      free(rec.win);
+      rec.busy = 0;
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * rec_open() creates or reuses the ring file for pre seconds   *
+ * before and post seconds after a trigger. thres is the trigger*
+ * acceleration magnitude in m/s^2, 0 disables it. A trigger    *
+ * pending in the file from a crashed run is exported first.    *
+ * ------------------------------------------------------------ */
+int rec_open(char *file, int pre, int post, double thres, int unitsel, int fmt) {
+   uint32_t nslot = (pre + post) * BNO_REC_MAXHZ;
+   int fd;
+
+   if(strlen(file) >= sizeof(rec.file) || pre < 0 || post < 0 || nslot == 0) {
+      printf("Error: invalid flight recorder arguments.\n");
+      return(-1);
+   }
+   strcpy(rec.file, file);
+   rec.pre = (int64_t) pre * 1000000;
+   rec.post = (int64_t) post * 1000000;
+   rec.fmt = fmt;
+
+   /* -------------------------------------------------------- *
+    * acc LSB: 1 m/s^2 = 100 LSB, or 1 mg = 1 LSB (unit bit 0) *
+    * -------------------------------------------------------- */
+   double lsb = (unitsel & 0x01) ? 1000.0 / 9.80665 : 100.0;
+   rec.thres2 = (int64_t) (thres * lsb) * (int64_t) (thres * lsb);
+
+   if((fd = open(file, O_RDWR | O_CREAT, 0644)) < 0) {
+      printf("Error: Can't open %s for writing.\n", file);
+      return(-1);
+   }
+   rec.size = sizeof(struct bnorechdr) + (size_t) nslot * sizeof(struct bnorecslot);
+   if(ftruncate(fd, rec.size) != 0) {
+      printf("Error: Can't resize %s to %zu bytes.\n", file, rec.size);
+      close(fd);
+      return(-1);
+   }
+   void *map = mmap(NULL, rec.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if(map == MAP_FAILED) {
+      printf("Error: Can't map %s for writing.\n", file);
+      return(-1);
+   }
+   rec.hdr = map;
+   rec.slot = (struct bnorecslot *) (rec.hdr + 1);
+
+   if(memcmp(rec.hdr->magic, BNO_REC_MAGIC, 4) == 0 && rec.hdr->version == BNO_REC_VERSION
+      && rec.hdr->nslot == nslot && rec.hdr->trigger != 0) {
+      if(verbose == 1) printf("Debug: Recorder exporting the trigger of a previous run\n");
+      rec_freeze();
+   }
+   memcpy(rec.hdr->magic, BNO_REC_MAGIC, 4);
+   rec.hdr->version = BNO_REC_VERSION;
+   rec.hdr->nslot = nslot;
+   rec.hdr->unitsel = unitsel;
+   rec.hdr->head = 0;
+   rec.hdr->trigger = 0;
+
+   signal(SIGUSR2, rec_signal);
+   if(verbose == 1) printf("Debug: Recorder ring [%s] slots [%u] size [%zu]\n", file, nslot, rec.size);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * rec_write() stores one sample in the ring. The slot is filled*
+ * before head moves on, so a reader never sees a partial slot. *
+ * ------------------------------------------------------------ */
+void rec_write(struct bnoraw *r) {
+   if(rec.hdr == NULL) return;
+
+   uint64_t head = rec.hdr->head;
+   struct bnorecslot *s = &rec.slot[head % rec.hdr->nslot];
+   int64_t us = (int64_t) r->ts.tv_sec * 1000000 + r->ts.tv_nsec / 1000;
+   s->us = us;
+   memcpy(s->val, r->val, sizeof(s->val));
+   __atomic_store_n(&rec.hdr->head, head + 1, __ATOMIC_RELEASE);
+
+   /* -------------------------------------------------------- *
+    * Reap a finished export, the ring is then armed again     *
+    * -------------------------------------------------------- */
+   if(rec.busy == 1 && rec.done == 1) {
+      pthread_join(rec.thread, NULL);
+      rec.busy = 0;
+   }
+
+   if(rec.hdr->trigger == 0) {
+      int64_t ax = r->val[0], ay = r->val[1], az = r->val[2];
+      int hit = rec.thres2 > 0 && ax * ax + ay * ay + az * az >= rec.thres2;
+      if(rec.request == 1 || hit) {
+         rec.request = 0;
+         if(rec.busy == 0) {
+            rec.hdr->trigger = us;
+            rec.triggers++;
+            if(verbose == 1) printf("Debug: Recorder triggered by [%s]\n", hit ? "acceleration" : "request");
+         }
+         else {
+            rec.skipped++;
+            if(verbose == 1) printf("Debug: Recorder trigger by [%s] skipped, export still running\n", hit ? "acceleration" : "request");
+         }
+      }
+   }
+   else if(us - rec.hdr->trigger >= rec.post) rec_freeze();
+}
+
+/* ------------------------------------------------------------ *
+ * rec_close() exports a trigger with an incomplete post window,*
+ * waits for the export to finish, and unmaps the ring file.    *
+ * ------------------------------------------------------------ */
+void rec_close() {
+   if(rec.hdr == NULL) return;
+   if(rec.busy == 0 && rec.hdr->trigger != 0) rec_freeze();
+   if(rec.busy == 1) pthread_join(rec.thread, NULL);
+   rec.busy = 0;
+   munmap(rec.hdr, rec.size);
+   rec.hdr = NULL;
+}
+
+/* ------------------------------------------------------------ *
+ * rec_report() prints the trigger counters. A trigger that     *
+ * comes while the previous window is still written to its file *
+ * is not recorded, it is counted as skipped.                   *
+ * ------------------------------------------------------------ */
+void rec_report(FILE *fp) {
+   if(rec.file[0] == '\0') return;
+   fprintf(fp, "Recorder: %lu triggers, %lu skipped during an export\n", rec.triggers, rec.skipped);
+}
+
+/* ------------------------------------------------------------ *
+ * rec_load() reads all samples of a ring file, oldest first,   *
+ * into a new array. Returns the sample count, or -1 on errors. *
+ * ------------------------------------------------------------ */
+int rec_load(char *file, struct bnoraw **out, int *unitsel) {
+   struct stat st;
+   int fd;
+
+   if((fd = open(file, O_RDONLY)) < 0) {
+      printf("Error: Can't open %s for reading.\n", file);
+      return(-1);
+   }
+   if(fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(struct bnorechdr)) {
+      printf("Error: %s is not a flight recorder file.\n", file);
+      close(fd);
+      return(-1);
+   }
+   void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+   if(map == MAP_FAILED) {
+      printf("Error: Can't map %s for reading.\n", file);
+      return(-1);
+   }
+   struct bnorechdr *hdr = map;
+   struct bnorecslot *slot = (struct bnorecslot *) (hdr + 1);
+   if(memcmp(hdr->magic, BNO_REC_MAGIC, 4) != 0 || hdr->version != BNO_REC_VERSION
+      || sizeof(*hdr) + (size_t) hdr->nslot * sizeof(*slot) > (size_t) st.st_size) {
+      printf("Error: %s is not a flight recorder file.\n", file);
+      munmap(map, st.st_size);
+      return(-1);
+   }
+
+   uint64_t n, head = hdr->head;
+   uint64_t first = head > hdr->nslot ? head - hdr->nslot : 0;
+   *unitsel = hdr->unitsel;
+   if((*out = malloc((head - first + 1) * sizeof(struct bnoraw))) == NULL) {
+      munmap(map, st.st_size);
+      return(-1);
+   }
+   for(n = first; n < head; n++) rec_slot(slot, hdr->nslot, n, &(*out)[n - first]);
+   munmap(map, st.st_size);
+   return(head - first);
+}
@@ -0,0 +1,253 @@
+/* ------------------------------------------------------------ *
+ * file:        sched_bno055.c                                  *
+ * purpose:     Sample rate scheduler for the continuous mode.  *
+ *              Samples are taken on a fixed grid of absolute   *
+ *              CLOCK_MONOTONIC deadlines, so the rate does not *
+ *              drift with the I2C and output processing time.  *
+ *              In adaptive mode, the motion energy from gyro   *
+ *              and linear acceleration decides between the     *
+ *              full and the idle rate. The sensor power mode   *
+ *              is not switched here, see sched_init().         *
+ *              Without a rate, the reads are phase-locked to   *
+ *              the sensor data updates: after new data, sleep  *
+ *              one update period minus a lead, and poll with a *
+ *              short step until the data changes. The lead is  *
+ *              adjusted so that the first read hits the update.*
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "getbno055.h"
+
+#define SCHED_STEP   500000   // sync mode poll step in nsec
+#define SCHED_STACK  (256 * 1024) // stack pre-faulted in real-time mode
+
+/* ------------------------------------------------------------ *
+ * Scheduler state                                              *
+ * ------------------------------------------------------------ */
+static struct {
+   int64_t period;                   // full rate period in nsec
+   int64_t idleperiod;               // idle rate period, 0 = fixed
+   int64_t cur;                      // current period in nsec
+   int64_t next;                     // next sample deadline
+   int64_t start;                    // scheduler start time
+   int64_t lastmotion;               // time of the last motion
+   int64_t lead;                     // sync: wake up before the update
+   int64_t lastfresh;                // sync: time of the last new data
+   int tries;                        // sync: reads since the new data
+   int sync;                         // 1 = phase-locked to the sensor
+   int idle;                         // 1 = running at the idle rate
+   unsigned long samples;            // samples taken
+   unsigned long idlesamples;        // samples taken at the idle rate
+   unsigned long switches;           // rate changes
+   unsigned long dups;               // reads without new data
+   int64_t latmax;                   // worst wakeup latency in nsec
+   int64_t latsum;                   // sum of wakeup latencies
+   unsigned long wakeups;            // timed wakeups
+   uint64_t xfer0;                   // bno_busstat.xfers at sched_init()
+} sc;
+
+static int64_t mono_ns(clockid_t clk) {
+   struct timespec ts;
+   clock_gettime(clk, &ts);
+   return((int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+/* ------------------------------------------------------------ *
+ * sched_init() sets the full sample rate in Hz. An idle rate   *
+ * > 0 enables the adaptive mode. A rate of 0 means no pacing   *
+ * at all, or if sync is 1, reads phase-locked to the sensor    *
+ * output updates. The low power mode is set once before, the   *
+ * sensor then sleeps and wakes up by itself: a power mode      *
+ * switch in the loop passes through CONFIG mode, which blocks  *
+ * for 90ms and restarts the fusion.                            *
+ * ------------------------------------------------------------ */
+int sched_init(double hz, double idlehz, int sync) {
+   if(hz < 0 || idlehz < 0 || (hz == 0 && idlehz > 0) || (idlehz > hz)) {
+      printf("Error: invalid sample rate %.1f Hz, idle rate %.1f Hz.\n", hz, idlehz);
+      return(-1);
+   }
+   sc.period = hz > 0 ? 1e9 / hz : 0;
+   sc.idleperiod = idlehz > 0 ? 1e9 / idlehz : 0;
+   sc.cur = sc.period;
+   if(hz == 0 && sync == 1) {
+      sc.sync = 1;
+      sc.period = sc.cur = 1e9 / BNO_FUSION_HZ;
+      sc.lead = SCHED_STEP;
+   }
+   sc.start = sc.next = sc.lastmotion = mono_ns(CLOCK_MONOTONIC);
+   sc.xfer0 = bno_busstat.xfers;
+   if(verbose == 1) printf("Debug: Sample rate [%.1f Hz] idle rate [%.1f Hz]\n", hz, idlehz);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * sched_prefault() touches a stack area, so that the pages are *
+ * mapped and locked before the loop, not at the first use. The *
+ * stores go through volatile, one per page, or gcc drops them. *
+ * ------------------------------------------------------------ */
+static void sched_prefault() {
+   volatile unsigned char stack[SCHED_STACK];
+   int i;
+   for(i = 0; i < SCHED_STACK; i += 4096) stack[i] = 0;
+   (void) stack;
+}
+
+/* ------------------------------------------------------------ *
+ * sched_rt() makes the calling thread real-time: SCHED_FIFO at *
+ * prio, pinned to cpu if cpu >= 0, with all current and future *
+ * memory locked. Threads started before keep the normal policy.*
+ * ------------------------------------------------------------ */
+int sched_rt(int prio, int cpu) {
+   struct sched_param sp = { .sched_priority = prio };
+
+   if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+      printf("Error: cannot lock memory, mlockall needs CAP_IPC_LOCK or a memlock limit.\n");
+      return(-1);
+   }
+   sched_prefault();
+
+   if(cpu >= 0) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpu, &set);
+      if(pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+         printf("Error: cannot pin the acquisition thread to CPU %d.\n", cpu);
+         return(-1);
+      }
+   }
+   if(pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) != 0) {
+      printf("Error: cannot set SCHED_FIFO priority %d, needs CAP_SYS_NICE or root.\n", prio);
+      return(-1);
+   }
+   if(verbose == 1) printf("Debug: Real-time mode SCHED_FIFO [%d] CPU [%d] memory locked\n", prio, cpu);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * sched_wait() sleeps until the next deadline. If the deadline *
+ * was missed by more than a period, the grid restarts from now *
+ * instead of taking a burst of samples to catch up.            *
+ * ------------------------------------------------------------ */
+void sched_wait() {
+   sc.samples++;
+   if(sc.idle == 1) sc.idlesamples++;
+   if(sc.cur == 0) return;
+
+   int64_t now = mono_ns(CLOCK_MONOTONIC);
+   if(now - sc.next > sc.cur) sc.next = now;
+   struct timespec ts = { sc.next / 1000000000, sc.next % 1000000000 };
+   clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+   int64_t lat = mono_ns(CLOCK_MONOTONIC) - sc.next;
+   if(lat > 0) {
+      if(lat > sc.latmax) sc.latmax = lat;
+      sc.latsum += lat;
+   }
+   sc.wakeups++;
+   if(sc.sync == 0) sc.next += sc.cur;
+}
+
+/* ------------------------------------------------------------ *
+ * sched_sync() is called after each read, fresh is 0 if the    *
+ * data is unchanged. In sync mode it sets the next deadline,   *
+ * and tracks the sensor update period between data changes.    *
+ * ------------------------------------------------------------ */
+void sched_sync(int fresh) {
+   if(fresh == 0) sc.dups++;
+   if(sc.sync == 0) return;
+
+   int64_t now = mono_ns(CLOCK_MONOTONIC);
+   if(fresh == 0) {
+      sc.tries++;
+      sc.next = now + SCHED_STEP;
+      return;
+   }
+
+   if(sc.lastfresh > 0) {
+      int64_t iv = now - sc.lastfresh;
+      if(iv > sc.cur / 2 && iv < sc.cur * 3 / 2) sc.cur += (iv - sc.cur) / 16;
+   }
+   /* -------------------------------------------------------- *
+    * New data at the first read means we may be late, wake up *
+    * earlier. Otherwise the update was within the last step.  *
+    * -------------------------------------------------------- */
+   if(sc.tries == 0 && sc.lead < sc.cur / 2) sc.lead += SCHED_STEP / 2;
+   else if(sc.tries > 0 && sc.lead >= SCHED_STEP / 2) sc.lead -= SCHED_STEP / 2;
+   sc.tries = 0;
+   sc.lastfresh = now;
+   sc.next = now + sc.cur - sc.lead;
+}
+
+/* ------------------------------------------------------------ *
+ * sched_update() checks the sample for motion, s needs the gyr *
+ * and lin channels. A sample with motion restores the full rate*
+ * at once, so the next sample is one full rate period later.   *
+ * ------------------------------------------------------------ */
+void sched_update(struct bnosample *s, int unitsel) {
+   if(sc.idleperiod == 0) return;
+
+   double lfact = (unitsel & 0x01) ? 0.00980665 : 1.0; // mg -> m/s^2
+   double g2 = s->gyr.gdata_x * s->gyr.gdata_x + s->gyr.gdata_y * s->gyr.gdata_y
+             + s->gyr.gdata_z * s->gyr.gdata_z;
+   double l2 = (s->lin.linacc_x * s->lin.linacc_x + s->lin.linacc_y * s->lin.linacc_y
+             + s->lin.linacc_z * s->lin.linacc_z) * lfact * lfact;
+   int64_t now = mono_ns(CLOCK_MONOTONIC);
+
+   if(g2 > BNO_IDLE_GYR_DPS * BNO_IDLE_GYR_DPS || l2 > BNO_IDLE_LIN_MS2 * BNO_IDLE_LIN_MS2) {
+      sc.lastmotion = now;
+      if(sc.idle == 0) return;
+      sc.idle = 0;
+      sc.cur = sc.period;
+      sc.next = now + sc.cur;
+      sc.switches++;
+      if(verbose == 1) printf("Debug: Motion, full sample rate\n");
+   }
+   else if(sc.idle == 0 && now - sc.lastmotion >= (int64_t) BNO_IDLE_HOLDMS * 1000000) {
+      sc.idle = 1;
+      sc.cur = sc.idleperiod;
+      sc.next = now + sc.cur;
+      sc.switches++;
+      if(verbose == 1) printf("Debug: No motion, idle sample rate\n");
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * sched_report() compares the I2C transactions and CPU time to *
+ * polling at the full rate over the same time. The transfers   *
+ * are the bus counts, with retries, health checks and the read *
+ * plans. A fixed rate run is estimated from the transfers and  *
+ * CPU time per sample.                                         *
+ * ------------------------------------------------------------ */
+void sched_report(FILE *fp) {
+   if(sc.samples == 0) return;
+
+   double elapsed = (mono_ns(CLOCK_MONOTONIC) - sc.start) / 1e9;
+   fprintf(fp, "Samples: %lu in %.1f s, %lu duplicates (%.1f%%), %lu at idle rate, %lu rate changes\n",
+           sc.samples, elapsed, sc.dups, 100.0 * sc.dups / sc.samples, sc.idlesamples, sc.switches);
+   if(sc.sync == 1) fprintf(fp, "Sensor update period: %.3f ms, read lead %.3f ms\n",
+                            sc.cur / 1e6, sc.lead / 1e6);
+   if(sc.wakeups > 0) fprintf(fp, "Wakeup latency: max %.1f us, mean %.1f us\n",
+                              sc.latmax / 1e3, sc.latsum / 1e3 / sc.wakeups);
+   if(sc.idleperiod == 0) return;  // fixed rate, nothing to compare
+
+   double cpu = mono_ns(CLOCK_PROCESS_CPUTIME_ID) / 1e9;
+   double fixed = elapsed * 1e9 / sc.period;
+   if(fixed < sc.samples) fixed = sc.samples;
+   double fixedcpu = cpu / sc.samples * fixed;
+   uint64_t xfers = bno_busstat.xfers - sc.xfer0;
+   double fixedxfers = (double) xfers / sc.samples * fixed;
+
+   fprintf(fp, "I2C transactions: %llu, fixed rate %.0f, saved %.1f%%\n", (unsigned long long) xfers,
+           fixedxfers, 100.0 * (1.0 - xfers / fixedxfers));
+   fprintf(fp, "CPU time: %.3f s, fixed rate est. %.3f s, saved %.1f%%\n",
+           cpu, fixedcpu, 100.0 * (1.0 - cpu / fixedcpu));
+}
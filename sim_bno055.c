@@ -0,0 +1,293 @@
+/* ------------------------------------------------------------ *
+ * file:        sim_bno055.c                                    *
+ * purpose:     Simulated BNO055 as bus backend, "-b sim". It   *
+ *              holds both register map pages in memory, with   *
+ *              the page switch, reset, mode and auto-increment *
+ *              behaviour of the sensor. It starts in NDOF mode *
+ *              as if configured by an earlier run, a reset     *
+ *              brings it to CONFIG mode after 650ms without an *
+ *              answer on the bus. In a fusion mode, the        *
+ *              data registers update at 100Hz from a synthetic *
+ *              motion: 10 seconds of turning and tilting, then *
+ *              10 seconds at rest, with one LSB of noise so    *
+ *              that each update has new data. Data is in the   *
+ *              default units (m/s^2, dps, degrees), UNIT_SEL   *
+ *              is kept but not applied. Transfers take the     *
+ *              time they need on a 400kHz bus. No hardware is  *
+ *              needed to test the program, its output formats  *
+ *              and timing. The start and end of the motion set *
+ *              the any-motion and no-motion interrupts, and the*
+ *              INT pin is an eventfd for "-I sim".             *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "getbno055.h"
+
+#define SIM_MOVE_SEC   10     // seconds of motion per cycle
+#define SIM_CYCLE_SEC  20     // motion plus rest period
+#define SIM_BUS_HZ     400000 // emulated I2C fast mode clock
+#define SIM_BOOT_MS    650    // no answer after a reset
+
+static struct {
+   unsigned char reg[2][128];  // page 0 and page 1 register maps
+   int addr;                   // register address pointer
+   int64_t start;              // time of the last reset in nsec
+   int64_t update;             // last fusion update number
+   int64_t bootend;            // end of the boot time after a reset
+   int move;                   // 1 = in the motion part of the cycle
+} sim;
+
+static int simirq = -1;        // eventfd of the INT pin, kept on reset
+
+/* ------------------------------------------------------------ *
+ * sim_now() returns the CLOCK_MONOTONIC time in nsec           *
+ * ------------------------------------------------------------ */
+static int64_t sim_now() {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+/* ------------------------------------------------------------ *
+ * sim_reset() sets the power-on register defaults              *
+ * ------------------------------------------------------------ */
+static void sim_reset() {
+   memset(&sim, 0, sizeof(sim));
+   unsigned char *p0 = sim.reg[0], *p1 = sim.reg[1];
+   p0[BNO055_CHIP_ID_ADDR] = BNO055_ID;
+   p0[0x01] = 0xFB;                      // ACC_ID
+   p0[0x02] = 0x32;                      // MAG_ID
+   p0[0x03] = 0x0F;                      // GYR_ID
+   p0[0x04] = 0x11;                      // SW_REV_ID_LSB
+   p0[0x05] = 0x03;                      // SW_REV_ID_MSB
+   p0[0x06] = 0x15;                      // BL_REV_ID
+   p0[BNO055_CALIB_STAT_ADDR] = 0xFF;    // fully calibrated
+   p0[BNO055_SELFTSTRES_ADDR] = 0x0F;    // all self tests passed
+   p0[BNO055_UNIT_SEL_ADDR] = 0x80;      // Android orientation
+   p0[BNO055_AXIS_MAP_CONFIG_ADDR] = 0x24;
+   p0[ACCEL_RADIUS_LSB_ADDR] = 0xE8;     // 1000
+   p0[ACCEL_RADIUS_LSB_ADDR + 1] = 0x03;
+   p0[MAG_RADIUS_LSB_ADDR] = 0xE0;       // 480
+   p0[MAG_RADIUS_LSB_ADDR + 1] = 0x01;
+   p1[BNO055_PAGE_ID_ADDR] = 1;
+   p1[BNO055_ACC_CONFIG_ADDR] = 0x0D;
+   p1[BNO055_MAG_CONFIG_ADDR] = 0x6D;
+   p1[BNO055_GYR_CONFIG0_ADDR] = 0x38;
+   p1[BNO055_ACC_AM_THRES_ADDR] = 0x14;
+   p1[BNO055_ACC_INT_SET_ADDR] = 0x03;
+   p1[BNO055_ACC_HG_DURATION_ADDR] = 0x0F;
+   p1[BNO055_ACC_HG_THRES_ADDR] = 0xC0;
+   p1[BNO055_ACC_NM_THRES_ADDR] = 0x0A;
+   p1[BNO055_ACC_NM_SET_ADDR] = 0x0B;
+   sim.start = sim_now();
+   sim.update = -1;
+}
+
+/* ------------------------------------------------------------ *
+ * sim_put() stores an int16 value in little endian registers   *
+ * ------------------------------------------------------------ */
+static void sim_put(int reg, double v) {
+   int16_t i = lround(v);
+   sim.reg[0][reg] = i & 0xFF;
+   sim.reg[0][reg + 1] = (i >> 8) & 0xFF;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_sim_irqfd() returns the eventfd of the INT pin, an edge  *
+ * is a write of 1. Returns -1 if no eventfd can be created.    *
+ * ------------------------------------------------------------ */
+int bno_sim_irqfd() {
+   if(simirq < 0) simirq = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+   return(simirq);
+}
+
+/* ------------------------------------------------------------ *
+ * sim_int() sets an interrupt in INT_STA if it is enabled in   *
+ * INT_EN. If it is routed to the pin by INT_MSK, and the pin   *
+ * is low, the pin goes high with an edge. The pin is released  *
+ * by RST_INT, which also clears INT_STA.                       *
+ * ------------------------------------------------------------ */
+static void sim_int(int bit) {
+   unsigned char *p0 = sim.reg[0], *p1 = sim.reg[1];
+   if(! (p1[BNO055_INT_EN_ADDR] & bit)) return;
+   int pin = p0[BNO055_INTR_STAT_ADDR] & p1[BNO055_INT_MSK_ADDR];
+   p0[BNO055_INTR_STAT_ADDR] |= bit;
+   if(pin == 0 && (p1[BNO055_INT_MSK_ADDR] & bit) && simirq >= 0) {
+      uint64_t one = 1;
+      if(write(simirq, &one, sizeof(one)) != sizeof(one)) return;
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * sim_noise() returns the raw noise of axis i in update k, 0-3 *
+ * LSB. The axes of a channel hold the base 4 digits of k, so   *
+ * its data repeats only after 64 updates (256 for the four     *
+ * quaternion values), and reads at any divisor of the update   *
+ * rate see new data in every update, also at rest.             *
+ * ------------------------------------------------------------ */
+static double sim_noise(int64_t k, int i) {
+   return((k >> (2 * i)) & 3);
+}
+
+/* ------------------------------------------------------------ *
+ * sim_update() computes the data registers of the last fusion  *
+ * update, only when a new update is due since the last read.   *
+ * ------------------------------------------------------------ */
+static void sim_update() {
+   unsigned char *p0 = sim.reg[0];
+   int mode = p0[BNO055_OPR_MODE_ADDR] & 0x0F;
+   p0[BNO055_SYS_STAT_ADDR] = mode == 0 ? 0x00 : (mode < 8 ? 0x06 : 0x05);
+   if(mode == 0) return;
+
+   int64_t k = (sim_now() - sim.start) / (1000000000 / BNO_FUSION_HZ);
+   if(k == sim.update) return;
+   sim.update = k;
+
+   /* -------------------------------------------------------- *
+    * Motion: heading turns at 20 dps, roll and pitch swing by *
+    * 10 and 5 degrees, with a small linear acceleration.      *
+    * -------------------------------------------------------- */
+   double t = (double) k / BNO_FUSION_HZ;
+   double tc = fmod(t, SIM_CYCLE_SEC);
+   double move = tc < SIM_MOVE_SEC ? 1.0 : 0.0;
+   double tm = floor(t / SIM_CYCLE_SEC) * SIM_MOVE_SEC + (move > 0 ? tc : SIM_MOVE_SEC);
+   double w1 = 2 * M_PI * 0.2, w2 = 2 * M_PI * 0.1;
+
+   double head = fmod(20.0 * tm, 360.0);
+   double roll = move * 10.0 * sin(w1 * tm);
+   double pitc = move * 5.0 * sin(w2 * tm);
+   double droll = move * 10.0 * w1 * cos(w1 * tm);
+   double dpitc = move * 5.0 * w2 * cos(w2 * tm);
+   double dhead = move * 20.0;
+   double lx = move * 0.5 * sin(2 * M_PI * 0.5 * t), ly = move * 0.3 * cos(2 * M_PI * 0.5 * t);
+   if((int) move != sim.move) sim_int(move > 0 ? BNO_INT_ACC_AM : BNO_INT_ACC_NM);
+   sim.move = move;
+
+   double h = head * M_PI / 180, r = roll * M_PI / 180, p = pitc * M_PI / 180;
+   double gx = 9.80665 * sin(r) * cos(p);
+   double gy = -9.80665 * sin(p);
+   double gz = 9.80665 * cos(r) * cos(p);
+
+   double cy = cos(h / 2), sy = sin(h / 2), cr = cos(r / 2), sr = sin(r / 2);
+   double cp = cos(p / 2), sp = sin(p / 2);
+   double qw = cy * cp * cr + sy * sp * sr;
+   double qx = cy * sp * cr + sy * cp * sr;
+   double qy = cy * cp * sr - sy * sp * cr;
+   double qz = -sy * cp * cr + cy * sp * sr;
+
+   sim_put(BNO055_ACC_DATA_X_LSB_ADDR, (gx + lx) * 100 + sim_noise(k, 0));
+   sim_put(BNO055_ACC_DATA_Y_LSB_ADDR, (gy + ly) * 100 + sim_noise(k, 1));
+   sim_put(BNO055_ACC_DATA_Z_LSB_ADDR, gz * 100 + sim_noise(k, 2));
+   sim_put(BNO055_MAG_DATA_X_LSB_ADDR, 20.0 * cos(h) * 16 + sim_noise(k, 0));
+   sim_put(BNO055_MAG_DATA_Y_LSB_ADDR, -20.0 * sin(h) * 16 + sim_noise(k, 1));
+   sim_put(BNO055_MAG_DATA_Z_LSB_ADDR, -40.0 * 16 + sim_noise(k, 2));
+   sim_put(BNO055_GYRO_DATA_X_LSB_ADDR, dpitc * 16);
+   sim_put(BNO055_GYRO_DATA_Y_LSB_ADDR, droll * 16);
+   sim_put(BNO055_GYRO_DATA_Z_LSB_ADDR, dhead * 16);
+   sim_put(BNO055_EULER_H_LSB_ADDR, head * 16 + sim_noise(k, 0));
+   sim_put(BNO055_EULER_R_LSB_ADDR, roll * 16 + sim_noise(k, 1));
+   sim_put(BNO055_EULER_P_LSB_ADDR, pitc * 16 + sim_noise(k, 2));
+   sim_put(BNO055_QUATERNION_DATA_W_LSB_ADDR, qw * 16384 - sim_noise(k, 0));
+   sim_put(BNO055_QUATERNION_DATA_X_LSB_ADDR, qx * 16384 + sim_noise(k, 1));
+   sim_put(BNO055_QUATERNION_DATA_Y_LSB_ADDR, qy * 16384 + sim_noise(k, 2));
+   sim_put(BNO055_QUATERNION_DATA_Z_LSB_ADDR, qz * 16384 + sim_noise(k, 3));
+   sim_put(BNO055_LIN_ACC_DATA_X_LSB_ADDR, lx * 100);
+   sim_put(BNO055_LIN_ACC_DATA_Y_LSB_ADDR, ly * 100);
+   sim_put(BNO055_LIN_ACC_DATA_Z_LSB_ADDR, 0);
+   sim_put(BNO055_GRAVITY_DATA_X_LSB_ADDR, gx * 100);
+   sim_put(BNO055_GRAVITY_DATA_Y_LSB_ADDR, gy * 100);
+   sim_put(BNO055_GRAVITY_DATA_Z_LSB_ADDR, gz * 100);
+   p0[BNO055_TEMP_ADDR] = 25;
+}
+
+/* ------------------------------------------------------------ *
+ * sim_xfer() takes the time of a transfer on a 400kHz bus: the *
+ * address byte plus len bytes, 9 clocks each with the ack bit. *
+ * ------------------------------------------------------------ */
+static void sim_xfer(int len) {
+   struct timespec ts = { 0, (long) ((len + 1) * 9 * 1e9 / SIM_BUS_HZ) };
+   nanosleep(&ts, NULL);
+}
+
+static int sim_open(const char *dev, int addr) {
+   if(addr != 0x28 && addr != 0x29) {
+      bno_error("can't find sensor at address [0x%02X].\n", addr);
+      return(-1);
+   }
+   if(sim.start != 0) return(0);             // reopen, the sensor stays
+   sim_reset();
+   sim.reg[0][BNO055_OPR_MODE_ADDR] = BNO_MODE_NDOF;  // as set up by an earlier run
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * sim_write() sets the address pointer, and writes the data    *
+ * bytes with auto-increment. Read-only registers are ignored,  *
+ * PAGE_ID, SYS_TRIGGER and OPR_MODE act like on the sensor.    *
+ * ------------------------------------------------------------ */
+static int sim_write(const void *buf, int len) {
+   const unsigned char *p = buf;
+   int i;
+   if(len < 1) return(-1);
+   sim_xfer(len);
+   if(sim_now() < sim.bootend) return(-1);
+   sim.addr = p[0] & 0x7F;
+
+   for(i = 1; i < len; i++) {
+      int page = sim.reg[0][BNO055_PAGE_ID_ADDR] & 0x01;
+      int a = (sim.addr + i - 1) & 0x7F;
+      if(a == BNO055_PAGE_ID_ADDR) {
+         sim.reg[0][a] = sim.reg[1][a] = p[i] & 0x01;
+         continue;
+      }
+      if(page == 1) {
+         if(a >= BNO055_ACC_CONFIG_ADDR) sim.reg[1][a] = p[i];
+         continue;
+      }
+      if(a == BNO055_SYS_TRIGGER_ADDR) {
+         if(p[i] & 0x20) {
+            sim_reset();
+            sim.bootend = sim.start + SIM_BOOT_MS * 1000000LL;
+            return(len);
+         }
+         if(p[i] & BNO_SYS_RST_INT) sim.reg[0][BNO055_INTR_STAT_ADDR] = 0;
+         sim.reg[0][a] = p[i] & 0x80;
+         continue;
+      }
+      if(a == BNO055_OPR_MODE_ADDR) { sim.reg[0][a] = p[i] & 0x0F; continue; }
+      if(a >= BNO055_UNIT_SEL_ADDR) sim.reg[0][a] = p[i];
+   }
+   return(len);
+}
+
+/* ------------------------------------------------------------ *
+ * sim_read() returns len bytes from the address pointer        *
+ * ------------------------------------------------------------ */
+static int sim_read(void *buf, int len) {
+   unsigned char *p = buf;
+   int page = sim.reg[0][BNO055_PAGE_ID_ADDR] & 0x01;
+   int i;
+   sim_xfer(len);
+   if(sim_now() < sim.bootend) return(-1);
+   if(page == 0) sim_update();
+   for(i = 0; i < len; i++) p[i] = sim.reg[page][(sim.addr + i) & 0x7F];
+   if(page == 0 && sim.addr <= BNO055_INTR_STAT_ADDR && sim.addr + len > BNO055_INTR_STAT_ADDR)
+      sim.reg[0][BNO055_INTR_STAT_ADDR] = 0;     // INT_STA clears on read
+   sim.addr = (sim.addr + len) & 0x7F;
+   return(len);
+}
+
+static void sim_close() {
+}
+
+const struct bnobus bno_simbus = {
+   "sim", sim_open, sim_write, sim_read, sim_close
+};
@@ -0,0 +1,153 @@
+/* ------------------------------------------------------------ *
+ * file:        trace_bno055.c                                  *
+ * purpose:     In-memory trace of the bus operations and the   *
+ *              sensor sleeps, written as Chrome trace JSON at  *
+ *              program exit. Open the file in chrome://tracing *
+ *              or ui.perfetto.dev to see where the time goes:  *
+ *              page switches, mode switches, sleeps, or reads. *
+ *              The buffer is a ring, it keeps the last events. *
+ *              Without -x, the transport tests bno_trace_on.   *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "getbno055.h"
+
+int bno_trace_on = 0;        // 1 = record bus events, set by bno_trace_open()
+
+/* ------------------------------------------------------------ *
+ * One trace event, times are CLOCK_MONOTONIC nsec              *
+ * ------------------------------------------------------------ */
+struct bnotrace {
+   int64_t t0, t1;      // start and end of the operation
+   const char *who;     // calling function of a sleep
+   int32_t len;         // bytes requested
+   int32_t res;         // bytes transferred or -1, usec of a sleep
+   uint8_t type;        // BNO_TR_xxx
+   uint8_t reg;         // register address
+   uint8_t page;        // register map page
+};
+
+static struct {
+   char file[256];
+   struct bnotrace *ev;
+   unsigned long size;  // ring capacity in events
+   unsigned long count; // events recorded, ring index is count % size
+} tr;
+
+static const char *trname[] = { "addr", "read", "write", "sleep" };
+
+/* ------------------------------------------------------------ *
+ * bno_trace_now() returns the CLOCK_MONOTONIC time in nsec     *
+ * ------------------------------------------------------------ */
+int64_t bno_trace_now() {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_trace_add() records one event, overwriting the oldest    *
+ * one if the ring is full.                                     *
+ * ------------------------------------------------------------ */
+void bno_trace_add(int type, int reg, int page, int len, int res,
+               int64_t t0, int64_t t1, const char *who) {
+   struct bnotrace *e = &tr.ev[tr.count % tr.size];
+   e->t0 = t0;
+   e->t1 = t1;
+   e->who = who;
+   e->len = len;
+   e->res = res;
+   e->type = type;
+   e->reg = reg;
+   e->page = page;
+   tr.count++;
+}
+
+/* ------------------------------------------------------------ *
+ * trace_name() returns the event name. Writes to the page, the *
+ * mode and the trigger registers get their own names, so that  *
+ * they stand out in the trace viewer.                          *
+ * ------------------------------------------------------------ */
+static const char *trace_name(struct bnotrace *e) {
+   if(e->type == BNO_TR_WRITE && e->page == 0) {
+      switch(e->reg) {
+         case BNO055_OPR_MODE_ADDR:    return("mode");
+         case BNO055_PWR_MODE_ADDR:    return("power");
+         case BNO055_SYS_TRIGGER_ADDR: return("trigger");
+      }
+   }
+   if(e->type == BNO_TR_WRITE && e->reg == BNO055_PAGE_ID_ADDR) return("page");
+   if(e->type == BNO_TR_SLEEP && e->who != NULL) return(e->who);
+   return(trname[e->type]);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_trace_close() writes the ring as Chrome trace JSON       *
+ * "complete" events, timestamps in usec from the first event.  *
+ * Registered with atexit(), every exit path writes the trace.  *
+ * ------------------------------------------------------------ */
+void bno_trace_close() {
+   if(bno_trace_on == 0) return;
+   bno_trace_on = 0;
+
+   FILE *fp = fopen(tr.file, "w");
+   if(fp == NULL) {
+      printf("Error: Can't open trace file %s for writing.\n", tr.file);
+      return;
+   }
+   unsigned long first = tr.count > tr.size ? tr.count - tr.size : 0;
+   unsigned long i;
+   int64_t base = tr.count > 0 ? tr.ev[first % tr.size].t0 : 0;
+
+   fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"events\":%lu,\"dropped\":%lu},\n",
+           tr.count, first);
+   fprintf(fp, "\"traceEvents\":[\n");
+   fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"getbno055\"}},\n");
+   fprintf(fp, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"bus\"}}");
+   for(i = first; i < tr.count; i++) {
+      struct bnotrace *e = &tr.ev[i % tr.size];
+      fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+              "\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+              trace_name(e), e->type == BNO_TR_SLEEP ? "sleep" : "bus",
+              (e->t0 - base) / 1e3, (e->t1 - e->t0) / 1e3);
+      if(e->type == BNO_TR_SLEEP)
+         fprintf(fp, "\"usec\":%d}}", e->res);
+      else
+         fprintf(fp, "\"reg\":\"0x%02X\",\"page\":%d,\"dir\":\"%s\",\"len\":%d,\"res\":%d}}",
+                 e->reg, e->page, e->type == BNO_TR_READ ? "rd" : "wr", e->len, e->res);
+   }
+   fprintf(fp, "\n]}\n");
+   if(fclose(fp) != 0) {
+      printf("Error: write failure for trace file %s.\n", tr.file);
+      return;
+   }
+   if(bno_debug == 1) printf("Debug: Trace file %s, %lu events, %lu dropped\n",
+                           tr.file, tr.count - first, first);
+   free(tr.ev);
+   tr.ev = NULL;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_trace_open() allocates the ring for events and turns     *
+ * tracing on, the trace is written to file at program exit.    *
+ * ------------------------------------------------------------ */
+int bno_trace_open(char *file, int events) {
+   if(events <= 0) events = BNO_TR_EVENTS;
+   tr.ev = calloc(events, sizeof(struct bnotrace));
+   if(tr.ev == NULL) {
+      printf("Error: Can't allocate %d trace events.\n", events);
+      return(-1);
+   }
+   snprintf(tr.file, sizeof(tr.file), "%s", file);
+   tr.size = events;
+   tr.count = 0;
+   bno_trace_on = 1;
+   atexit(bno_trace_close);
+   if(bno_debug == 1) printf("Debug: Trace to %s, ring of %d events\n", file, events);
+   return(0);
+}
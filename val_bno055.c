@@ -0,0 +1,191 @@
+/* ------------------------------------------------------------ *
+ * file:        val_bno055.c                                    *
+ * purpose:     Sanity checks of the raw sample data, "-k".     *
+ *              I2C has no checksum, a corrupted read passes as *
+ *              valid data. The checks run on the int16 values  *
+ *              before the conversion, table driven and without *
+ *              branches per value, so they cost little at the  *
+ *              full rate:                                      *
+ *                                                              *
+ *              range  each value within the channel limits,    *
+ *                     e.g. heading 0..360, quaternion +-1      *
+ *              norm   quaternion length 1, gravity length 1g   *
+ *              jump   Euler angles change less than 45 degrees *
+ *                     between two reads less than 50ms apart   *
+ *                                                              *
+ *              An invalid sample is dropped, or read again     *
+ *              once with "-k reread". A re-read that returns   *
+ *              the same data is taken as real, not corrupted.  *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "getbno055.h"
+
+int val_mode = 0;        // -k BNO_VAL_xxx, 0 = no checks
+
+/* ------------------------------------------------------------ *
+ * Raw value limits and the channel of each raw value index. In *
+ * raw units: acc and lin 0.01m/s^2 or 1mg, mag 1/16uT, gyr and *
+ * eul 1/16 dps or degree, qua 1/16384, the widest sensor range *
+ * ------------------------------------------------------------ */
+static const int16_t vmin[BNO_RAW_COUNT] = {
+   -16000, -16000, -16000, -32768, -32768, -32768, -32000, -32000, -32000,
+   0, -2880, -2880, -16385, -16385, -16385, -16385,
+   -16000, -16000, -16000, -1100, -1100, -1100 };
+static const int16_t vmax[BNO_RAW_COUNT] = {
+   16000, 16000, 16000, 32767, 32767, 32767, 32000, 32000, 32000,
+   5760, 2880, 2880, 16385, 16385, 16385, 16385,
+   16000, 16000, 16000, 1100, 1100, 1100 };
+static const uint8_t vchan[BNO_RAW_COUNT] = {
+   0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 6, 6, 6 };
+static const char *chname[BNO_CH_COUNT] = { "ACC", "MAG", "GYR", "EUL", "QUA", "LIN", "GRA" };
+
+#define VAL_RANGE  0x01
+#define VAL_NORM   0x02
+#define VAL_JUMP   0x04
+
+/* ------------------------------------------------------------ *
+ * Norm limits as squared raw values: quaternion 16384^2 +-6%,  *
+ * gravity between 0.9 * 9.81m/s^2 and 1.1 * 1000mg.            *
+ * ------------------------------------------------------------ */
+#define VAL_QNORM_LO   ((int64_t) (16384.0 * 16384.0 * 0.94))
+#define VAL_QNORM_HI   ((int64_t) (16384.0 * 16384.0 * 1.06))
+#define VAL_GNORM_LO   ((int64_t) (883.0 * 883.0))
+#define VAL_GNORM_HI   ((int64_t) (1100.0 * 1100.0))
+
+static struct {
+   struct bnoraw prev;               // last valid sample
+   int haveprev;                     // 1 = prev can be used for jumps
+   int jumps;                        // jump failures in a row
+   unsigned long checked, invalid;   // samples checked, failed
+   unsigned long range, norm, jump;  // failures by check
+   unsigned long reread, rereadok;   // re-reads, re-reads valid
+   unsigned long dropped;            // samples not passed on
+   unsigned long chan[BNO_CH_COUNT]; // failures by channel
+} val;
+
+/* ------------------------------------------------------------ *
+ * val_init() sets the -k mode, "drop" or "reread"              *
+ * ------------------------------------------------------------ */
+int val_init(char *mode) {
+   if(strcmp(mode, "drop") == 0) val_mode = BNO_VAL_DROP;
+   else if(strcmp(mode, "reread") == 0) val_mode = BNO_VAL_REREAD;
+   else return(-1);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * val_check() returns 0 for a valid sample, or the VAL_xxx     *
+ * bits of the failed checks, the failed channels in *chbad.    *
+ * ------------------------------------------------------------ */
+static int val_check(struct bnoraw *raw, int *chbad) {
+   const int16_t *v = raw->val;
+   int i, bad = 0, ch = 0;
+
+   for(i = 0; i < BNO_RAW_COUNT; i++) {
+      int on = (raw->mask >> vchan[i]) & 1;
+      ch |= (on & ((v[i] < vmin[i]) | (v[i] > vmax[i]))) << vchan[i];
+   }
+   bad |= (ch != 0) * VAL_RANGE;
+
+   if(raw->mask & BNO_CH_QUA) {
+      int64_t n = (int64_t) v[12] * v[12] + (int64_t) v[13] * v[13]
+                + (int64_t) v[14] * v[14] + (int64_t) v[15] * v[15];
+      int f = (n < VAL_QNORM_LO) | (n > VAL_QNORM_HI);
+      bad |= f * VAL_NORM;
+      ch |= f << 4;
+   }
+   if(raw->mask & BNO_CH_GRA) {
+      int64_t n = (int64_t) v[19] * v[19] + (int64_t) v[20] * v[20] + (int64_t) v[21] * v[21];
+      int f = (n < VAL_GNORM_LO) | (n > VAL_GNORM_HI);
+      bad |= f * VAL_NORM;
+      ch |= f << 6;
+   }
+
+   /* -------------------------------------------------------- *
+    * Euler angle change since the last valid sample, heading  *
+    * wraps around at 360 degrees (5760)                       *
+    * -------------------------------------------------------- */
+   if((raw->mask & BNO_CH_EUL) && val.haveprev == 1
+      && raw->t1 - val.prev.t1 < BNO_VAL_JUMP_MS * 1000000LL) {
+      const int16_t *p = val.prev.val;
+      int lim = BNO_VAL_JUMP_DEG * 16;
+      int dh = ((v[9] - p[9] + 2880 + 5760) % 5760) - 2880;
+      int dr = v[10] - p[10], dp = v[11] - p[11];
+      int f = (abs(dh) > lim) | (abs(dr) > lim) | (abs(dp) > lim);
+      bad |= f * VAL_JUMP;
+      ch |= f << 3;
+   }
+   *chbad = ch;
+   return(bad);
+}
+
+/* ------------------------------------------------------------ *
+ * val_count() adds a failed check to the counters              *
+ * ------------------------------------------------------------ */
+static void val_count(int bad, int chbad) {
+   int i;
+   val.invalid++;
+   val.range += (bad & VAL_RANGE) != 0;
+   val.norm += (bad & VAL_NORM) != 0;
+   val.jump += (bad & VAL_JUMP) != 0;
+   for(i = 0; i < BNO_CH_COUNT; i++) val.chan[i] += (chbad >> i) & 1;
+}
+
+/* ------------------------------------------------------------ *
+ * val_sample() checks a sample from bno_get_raw(). It returns  *
+ * 0 if the sample, or its re-read, can be passed on, or -1 if  *
+ * it must be dropped. After BNO_VAL_JUMPS jump failures in a   *
+ * row, the orientation is taken as real, the check restarts.   *
+ * ------------------------------------------------------------ */
+int val_sample(struct bnoraw *raw) {
+   int chbad;
+   val.checked++;
+   int bad = val_check(raw, &chbad);
+
+   if(bad != 0) {
+      val_count(bad, chbad);
+      if(verbose == 1) printf("Debug: Invalid sample, checks [0x%02X] channels [0x%02X]\n", bad, chbad);
+
+      if(val_mode == BNO_VAL_REREAD) {
+         struct bnoraw again = *raw;    // bno_get_raw() only sets the masked channels
+         val.reread++;
+         if(bno_get_raw(&again, raw->mask) == 0) {
+            int same = memcmp(again.val, raw->val, sizeof(raw->val)) == 0;
+            int bad2 = val_check(&again, &chbad);
+            if(bad2 == 0 || (same == 1 && bad2 == VAL_JUMP)) {
+               val.rereadok++;
+               *raw = again;
+               bad = 0;
+            }
+         }
+      }
+   }
+   if(bad != 0) {
+      val.dropped++;
+      if(bad == VAL_JUMP && ++val.jumps >= BNO_VAL_JUMPS) val.haveprev = 0;
+      return(-1);
+   }
+   val.prev = *raw;
+   val.haveprev = 1;
+   val.jumps = 0;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * val_report() prints the rejection counters                   *
+ * ------------------------------------------------------------ */
+void val_report(FILE *fp) {
+   int i;
+   if(val_mode == 0) return;
+   fprintf(fp, "Validation: %lu checked, %lu invalid (range %lu, norm %lu, jump %lu), "
+           "%lu re-read ok, %lu dropped", val.checked, val.invalid, val.range, val.norm,
+           val.jump, val.rereadok, val.dropped);
+   for(i = 0; i < BNO_CH_COUNT; i++)
+      if(val.chan[i] > 0) fprintf(fp, ", %s %lu", chname[i], val.chan[i]);
+   fprintf(fp, "\n");
+}
@@ -0,0 +1,308 @@
+/* ------------------------------------------------------------ *
+ * file:        web_bno055.c                                    *
+ * purpose:     Minimal embedded HTTP server for the continuous *
+ *              mode. It serves the latest sample as JSON, and  *
+ *              streams all samples as Server-Sent Events from  *
+ *              an in-memory ring, without any disk file I/O.   *
+ *                                                              *
+ *              GET /json    latest sample as JSON object       *
+ *              GET /events  text/event-stream of all samples   *
+ *              GET /trigger flight recorder trigger (-f)       *
+ *              GET /hist    loop timing histograms as text     *
+ *              GET /metrics bus counters, Prometheus text      *
+ *                                                              *
+ * author:      10/16/2026 pi-bno055 project                    *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include "getbno055.h"
+
+#define WEB_MAXCLIENT  64    // concurrent HTTP connections
+#define WEB_RINGSIZE   64    // rendered samples kept for SSE
+#define WEB_LINESIZE   BNO_JSONSIZE // max length of one JSON sample
+#define WEB_REQSIZE    1024  // max length of a request header
+
+/* ------------------------------------------------------------ *
+ * Client connection state, one per accepted socket             *
+ * ------------------------------------------------------------ */
+struct webclient {
+   int fd;                   // socket, -1 if the slot is free
+   int sse;                  // 1 = subscribed to /events stream
+   unsigned long seq;        // next ring sequence to send
+   int reqlen;               // request bytes received so far
+   char req[WEB_REQSIZE];    // request header, until "\r\n\r\n"
+};
+
+/* ------------------------------------------------------------ *
+ * Server state, shared between acquisition and server thread.  *
+ * The acquisition loop only renders into the ring and signals  *
+ * the eventfd, all socket I/O happens in the server thread.    *
+ * ------------------------------------------------------------ */
+static struct {
+   int lfd;                  // listening socket
+   int efd;                  // eventfd, signals a new sample
+   pthread_t thread;
+   pthread_mutex_t lock;     // protects ring[] and seq
+   char ring[WEB_RINGSIZE][WEB_LINESIZE];
+   int  len[WEB_RINGSIZE];
+   unsigned long seq;        // number of samples published
+   struct webclient cl[WEB_MAXCLIENT];
+} web = { .lfd = -1, .efd = -1, .lock = PTHREAD_MUTEX_INITIALIZER };
+
+/* ------------------------------------------------------------ *
+ * web_close() closes a client connection and frees its slot    *
+ * ------------------------------------------------------------ */
+static void web_close(struct webclient *c) {
+   close(c->fd);
+   c->fd = -1;
+   c->sse = 0;
+   c->reqlen = 0;
+}
+
+/* ------------------------------------------------------------ *
+ * web_send() writes the full buffer or drops the client. The   *
+ * sockets are non-blocking: a viewer that cannot keep up gets  *
+ * disconnected instead of stalling everybody else.             *
+ * ------------------------------------------------------------ */
+static int web_send(struct webclient *c, const char *buf, int len) {
+   if(send(c->fd, buf, len, MSG_NOSIGNAL | MSG_DONTWAIT) != len) {
+      if(verbose == 1) printf("Debug: HTTP client fd [%d] dropped\n", c->fd);
+      web_close(c);
+      return(-1);
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * web_request() reads the HTTP request of a client, answered   *
+ * once the header is complete. A request can arrive in more    *
+ * than one segment, the bytes are collected in c->req until    *
+ * the blank line "\r\n\r\n" that ends the header.              *
+ * ------------------------------------------------------------ */
+static void web_request(struct webclient *c) {
+   char hdr[256];
+   char *req = c->req;
+
+   if(c->sse == 1) {         // ignore anything sent on a stream
+      char drop[256];
+      if(recv(c->fd, drop, sizeof(drop), MSG_DONTWAIT) <= 0) web_close(c);
+      return;
+   }
+   int n = recv(c->fd, req + c->reqlen, sizeof(c->req) - 1 - c->reqlen, MSG_DONTWAIT);
+   if(n <= 0) { web_close(c); return; }
+   c->reqlen += n;
+   req[c->reqlen] = '\0';
+
+   if(strstr(req, "\r\n\r\n") == NULL) {
+      if(c->reqlen < (int) sizeof(c->req) - 1) return;
+      int hlen = snprintf(hdr, sizeof(hdr), "HTTP/1.1 431 Request Header Fields Too Large\r\n"
+         "Content-Length: 0\r\nConnection: close\r\n\r\n");
+      if(web_send(c, hdr, hlen) == 0) web_close(c);
+      return;
+   }
+
+   if(strncmp(req, "GET /events", 11) == 0) {
+      static const char ssehdr[] = "HTTP/1.1 200 OK\r\n"
+         "Content-Type: text/event-stream\r\n"
+         "Cache-Control: no-cache\r\n"
+         "Access-Control-Allow-Origin: *\r\n"
+         "Connection: keep-alive\r\n\r\n";
+      if(web_send(c, ssehdr, sizeof(ssehdr) - 1) != 0) return;
+      pthread_mutex_lock(&web.lock);
+      c->seq = web.seq;
+      pthread_mutex_unlock(&web.lock);
+      c->sse = 1;
+      return;
+   }
+
+   if(strncmp(req, "GET /trigger", 12) == 0) {
+      rec_trigger();
+      int hlen = snprintf(hdr, sizeof(hdr), "HTTP/1.1 204 No Content\r\n"
+         "Access-Control-Allow-Origin: *\r\n"
+         "Connection: close\r\n\r\n");
+      if(web_send(c, hdr, hlen) == 0) web_close(c);
+      return;
+   }
+
+   int hist = strncmp(req, "GET /hist", 9) == 0;
+   if(hist || strncmp(req, "GET /metrics", 12) == 0) {
+      char body[4096];
+      FILE *mem = fmemopen(body, sizeof(body), "w");
+      if(mem == NULL) { web_close(c); return; }
+      if(hist) hist_print(mem);
+      else bno_bus_metrics(mem);
+      int blen = ftell(mem);
+      fclose(mem);
+
+      int hlen = snprintf(hdr, sizeof(hdr), "HTTP/1.1 200 OK\r\n"
+         "Content-Type: text/plain; version=0.0.4\r\n"
+         "Access-Control-Allow-Origin: *\r\n"
+         "Content-Length: %d\r\n"
+         "Connection: close\r\n\r\n", blen);
+      if(web_send(c, hdr, hlen) == 0 && web_send(c, body, blen) == 0) web_close(c);
+      return;
+   }
+
+   if(strncmp(req, "GET /json", 9) == 0 || strncmp(req, "GET / ", 6) == 0) {
+      char body[WEB_LINESIZE];
+      int blen = 0;
+      pthread_mutex_lock(&web.lock);
+      if(web.seq > 0) {
+         int i = (web.seq - 1) % WEB_RINGSIZE;
+         blen = web.len[i];
+         memcpy(body, web.ring[i], blen);
+      }
+      pthread_mutex_unlock(&web.lock);
+      if(blen == 0) { strcpy(body, "{}\n"); blen = 3; }
+
+      int hlen = snprintf(hdr, sizeof(hdr), "HTTP/1.1 200 OK\r\n"
+         "Content-Type: application/json\r\n"
+         "Access-Control-Allow-Origin: *\r\n"
+         "Content-Length: %d\r\n"
+         "Connection: close\r\n\r\n", blen);
+      if(web_send(c, hdr, hlen) == 0 && web_send(c, body, blen) == 0) web_close(c);
+      return;
+   }
+
+   int hlen = snprintf(hdr, sizeof(hdr), "HTTP/1.1 404 Not Found\r\n"
+      "Content-Length: 0\r\nConnection: close\r\n\r\n");
+   if(web_send(c, hdr, hlen) == 0) web_close(c);
+}
+
+/* ------------------------------------------------------------ *
+ * web_stream() sends all samples a SSE client has not yet seen *
+ * ------------------------------------------------------------ */
+static void web_stream(struct webclient *c) {
+   char msg[WEB_LINESIZE + 16];
+
+   pthread_mutex_lock(&web.lock);
+   if(web.seq - c->seq > WEB_RINGSIZE) c->seq = web.seq - WEB_RINGSIZE;
+   while(c->fd >= 0 && c->seq < web.seq) {
+      int i = c->seq % WEB_RINGSIZE;
+      /* ring lines end with "\n", SSE events end with a blank line */
+      int len = snprintf(msg, sizeof(msg), "data: %.*s\n", web.len[i], web.ring[i]);
+      c->seq++;
+      web_send(c, msg, len);
+   }
+   pthread_mutex_unlock(&web.lock);
+}
+
+/* ------------------------------------------------------------ *
+ * web_loop() is the server thread, waiting on the listening    *
+ * socket, the client sockets and the new sample eventfd.       *
+ * ------------------------------------------------------------ */
+static void *web_loop(void *arg) {
+   struct pollfd pfd[WEB_MAXCLIENT + 2];
+   int map[WEB_MAXCLIENT + 2];
+   int i, n;
+
+   while(1) {
+      pfd[0].fd = web.lfd; pfd[0].events = POLLIN;
+      pfd[1].fd = web.efd; pfd[1].events = POLLIN;
+      n = 2;
+      for(i = 0; i < WEB_MAXCLIENT; i++) {
+         if(web.cl[i].fd < 0) continue;
+         pfd[n].fd = web.cl[i].fd;
+         pfd[n].events = POLLIN;
+         map[n++] = i;
+      }
+      if(poll(pfd, n, -1) < 0) continue;
+
+      if(pfd[0].revents & POLLIN) {
+         int fd = accept(web.lfd, NULL, NULL);
+         if(fd >= 0) {
+            for(i = 0; i < WEB_MAXCLIENT && web.cl[i].fd >= 0; i++);
+            if(i == WEB_MAXCLIENT) close(fd);
+            else { web.cl[i].fd = fd; web.cl[i].sse = 0; web.cl[i].reqlen = 0; }
+         }
+      }
+
+      for(i = 2; i < n; i++)
+         if(pfd[i].revents & (POLLIN | POLLHUP | POLLERR)) web_request(&web.cl[map[i]]);
+
+      if(pfd[1].revents & POLLIN) {
+         uint64_t cnt;
+         if(read(web.efd, &cnt, sizeof(cnt)) != sizeof(cnt)) continue;
+         for(i = 0; i < WEB_MAXCLIENT; i++)
+            if(web.cl[i].fd >= 0 && web.cl[i].sse == 1) web_stream(&web.cl[i]);
+      }
+   }
+   return(arg);
+}
+
+/* ------------------------------------------------------------ *
+ * web_start() opens the HTTP listener on "[addr:]port" and     *
+ * starts the server thread. Without addr, it binds loopback.   *
+ * ------------------------------------------------------------ */
+int web_start(char *bind_arg) {
+   struct sockaddr_in sa;
+   char addr[64] = "127.0.0.1";
+   char *port = strrchr(bind_arg, ':');
+   int i, on = 1;
+
+   if(port != NULL) {
+      if(port - bind_arg >= (int) sizeof(addr)) return(-1);
+      memcpy(addr, bind_arg, port - bind_arg);
+      addr[port - bind_arg] = '\0';
+      port++;
+   }
+   else port = bind_arg;
+
+   memset(&sa, 0, sizeof(sa));
+   sa.sin_family = AF_INET;
+   sa.sin_port = htons(atoi(port));
+   if(inet_pton(AF_INET, addr, &sa.sin_addr) != 1 || sa.sin_port == 0) {
+      printf("Error: invalid HTTP bind address [%s].\n", bind_arg);
+      return(-1);
+   }
+
+   if((web.lfd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0) return(-1);
+   setsockopt(web.lfd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+   if(bind(web.lfd, (struct sockaddr *) &sa, sizeof(sa)) != 0 || listen(web.lfd, 16) != 0) {
+      printf("Error: cannot listen for HTTP on [%s:%s].\n", addr, port);
+      close(web.lfd);
+      return(-1);
+   }
+   if((web.efd = eventfd(0, EFD_CLOEXEC)) < 0) return(-1);
+   for(i = 0; i < WEB_MAXCLIENT; i++) web.cl[i].fd = -1;
+
+   if(pthread_create(&web.thread, NULL, web_loop, NULL) != 0) {
+      printf("Error: cannot start HTTP server thread.\n");
+      return(-1);
+   }
+   if(verbose == 1) printf("Debug: HTTP server listening on [%s:%s]\n", addr, port);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * web_publish() renders a sample as JSON into the ring and     *
+ * wakes up the server thread. Called once per sample from the  *
+ * acquisition loop, no matter how many viewers are connected.  *
+ * format_json() writes straight into the ring slot, there is   *
+ * no stream or heap allocation while the lock is held.         *
+ * ------------------------------------------------------------ */
+void web_publish(struct bnosample *s) {
+   if(web.efd < 0) return;
+
+   pthread_mutex_lock(&web.lock);
+   int i = web.seq % WEB_RINGSIZE;
+   int len = format_json(s, web.ring[i], WEB_LINESIZE);
+   if(len > 0) {
+      web.len[i] = len;
+      web.seq++;
+   }
+   pthread_mutex_unlock(&web.lock);
+
+   uint64_t one = 1;
+   if(write(web.efd, &one, sizeof(one)) != sizeof(one)) return;
+}